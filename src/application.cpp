@@ -10,7 +10,12 @@ namespace foundation {
         scene{std::make_shared<Scene>("scene", &context, &window)},
         gpu_scene{std::make_unique<GPUScene>(&context, scene.get())},
         asset_processor{std::make_unique<AssetProcessor>(&context)},
-        thread_pool{std::make_unique<ThreadPool>(std::thread::hardware_concurrency() - 1)},
+        thread_pool{std::make_unique<ThreadPool>(ThreadPoolInfo {
+            .compute_thread_count = std::thread::hardware_concurrency() - 1,
+            .io_thread_count = 2,
+            .latency_critical_thread_count = 1,
+            .max_queued_entries = { 0, 256, 0 },
+        })},
         asset_manager{std::make_unique<AssetManager>(&context, scene.get(), thread_pool.get(), asset_processor.get())},
         scene_hierarchy_panel{scene.get()} {
         PROFILE_SCOPE;
@@ -31,7 +36,7 @@ namespace foundation {
         };
 
         auto compile_pipelines_task = std::make_shared<CompilePipelinesTask>(renderer.get());
-        thread_pool->async_dispatch(compile_pipelines_task);
+        thread_pool->async_dispatch(compile_pipelines_task, TaskPriority::HIGH, TaskClass::LATENCY_CRITICAL);
     
         last_time_point = std::chrono::steady_clock::now();
         main_camera.camera.resize(s_cast<i32>(window.get_width()), s_cast<i32>(window.get_height()));
@@ -79,7 +84,7 @@ namespace foundation {
 //                 .path = "assets/binary/Sponza/Sponza.bmodel",
 //             };
 // #if COOK_ASSETS
-//             AssetProcessor::convert_gltf_to_binary("assets/models/Sponza/glTF/Sponza.gltf", "assets/binary/Sponza/Sponza.bmodel");
+//             AssetConverter::convert_gltf_to_binary("assets/models/Sponza/glTF/Sponza.gltf", "assets/binary/Sponza/Sponza.bmodel", thread_pool.get());
 // #else
 //             asset_manager->load_model(manifesto);
 // #endif
@@ -96,7 +101,7 @@ namespace foundation {
 //                 .path = "assets/binary/main_sponza/main_sponza.bmodel",
 //             };
 // #if COOK_ASSETS
-//             AssetProcessor::convert_gltf_to_binary("assets/models/main_sponza/NewSponza_Main_glTF_003.gltf", "assets/binary/main_sponza/main_sponza.bmodel");
+//             AssetConverter::convert_gltf_to_binary("assets/models/main_sponza/NewSponza_Main_glTF_003.gltf", "assets/binary/main_sponza/main_sponza.bmodel", thread_pool.get());
 // #else
 //             asset_manager->load_model(manifesto);
 // #endif
@@ -114,7 +119,7 @@ namespace foundation {
                 .path = "assets/binary/DamagedHelmet/DamagedHelmet.bmodel",
             };
 #if COOK_ASSETS
-            AssetProcessor::convert_gltf_to_binary("assets/models/DamagedHelmet/glTF/DamagedHelmet.gltf", "assets/binary/DamagedHelmet/DamagedHelmet.bmodel");
+            AssetConverter::convert_gltf_to_binary("assets/models/DamagedHelmet/glTF/DamagedHelmet.gltf", "assets/binary/DamagedHelmet/DamagedHelmet.bmodel", thread_pool.get());
 #else
             asset_manager->load_model(manifesto);
 #endif
@@ -132,7 +137,7 @@ namespace foundation {
                 .path = "assets/binary/Cubes/Cubes.bmodel",
             };
 #if COOK_ASSETS
-            AssetProcessor::convert_gltf_to_binary("assets/models/Cubes/Cubes.gltf", "assets/binary/Cubes/Cubes.bmodel");
+            AssetConverter::convert_gltf_to_binary("assets/models/Cubes/Cubes.gltf", "assets/binary/Cubes/Cubes.bmodel", thread_pool.get());
 #else
             asset_manager->load_model(manifesto);
 #endif
@@ -156,7 +161,7 @@ namespace foundation {
                         .path = "assets/binary/Bistro/Bistro.bmodel",
                     };
 #if COOK_ASSETS
-                    AssetProcessor::convert_gltf_to_binary("assets/models/Bistro/Bistro.glb", "assets/binary/Bistro/Bistro.bmodel");
+                    AssetConverter::convert_gltf_to_binary("assets/models/Bistro/Bistro.glb", "assets/binary/Bistro/Bistro.bmodel", thread_pool.get());
 #else           
                     asset_manager->load_model(manifesto);
 #endif                
@@ -174,7 +179,7 @@ namespace foundation {
 //                 .path = "assets/binary/small_city/small_city.bmodel",
 //             };
 // #if COOK_ASSETS
-//                     AssetProcessor::convert_gltf_to_binary("assets/models/small_city/small_city.gltf", "assets/binary/small_city/small_city.bmodel");
+//                     AssetConverter::convert_gltf_to_binary("assets/models/small_city/small_city.gltf", "assets/binary/small_city/small_city.bmodel", thread_pool.get());
 // #else           
 //                     asset_manager->load_model(manifesto);
 // #endif      
@@ -224,11 +229,12 @@ namespace foundation {
                 PROFILE_ZONE_NAMED(update_meshes);
                 asset_manager->stream_meshes();
                 PROFILE_ZONE_NAMED(record_gpu_load_processing_commands);
-                auto commands = asset_processor->record_gpu_load_processing_commands();
+                auto commands = asset_processor->record_gpu_load_processing_commands(asset_manager->poll_mesh_uploads());
                 PROFILE_ZONE_NAMED(record_manifest_update);
                 auto update_info = asset_manager->record_manifest_update(AssetManager::RecordManifestUpdateInfo {
                     .uploaded_meshes = commands.uploaded_meshes,
-                    .uploaded_textures = commands.uploaded_textures
+                    .uploaded_textures = commands.uploaded_textures,
+                    .cancelled_textures = commands.cancelled_textures,
                 });
 
                 auto gpu_scene_cmd_list = gpu_scene->update(GPUScene::UpdateInfo {
@@ -237,9 +243,14 @@ namespace foundation {
                 });
 
                 auto cmd_lists = std::array{std::move(commands.upload_commands), std::move(update_info.command_list), std::move(gpu_scene_cmd_list)};
+                auto signal_timelines = std::array{std::pair{asset_processor->upload_timeline, commands.upload_timeline_value}};
                 context.device.submit_commands(daxa::CommandSubmitInfo {
-                    .command_lists = cmd_lists
+                    .command_lists = cmd_lists,
+                    .signal_timeline_semaphores = signal_timelines,
                 });
+
+                PROFILE_ZONE_NAMED(poll_upload_waits);
+                asset_processor->upload_waits->poll();
             }
 
             update();
@@ -298,6 +309,9 @@ namespace foundation {
         }
 
         ImGui::Begin("Asset Manager Statistics");
+        ImGui::Text("Cancelled Loads: %llu", s_cast<unsigned long long>(asset_processor->cancelled_load_count->load(std::memory_order_relaxed)));
+        ImGui::Text("Bytes Saved By Cancellation: %.2f MB", s_cast<f64>(asset_processor->cancelled_load_bytes->load(std::memory_order_relaxed)) / (1024.0 * 1024.0));
+        ImGui::Text("Dropped Task Chunks: %llu", s_cast<unsigned long long>(thread_pool->dropped_chunk_count()));
         // ImGui::Text("Unique Mesh Count: %u", s_cast<u32>(asset_manager->total_unique_mesh_count));
         // ImGui::Text("Opaque Mesh Count: %u", s_cast<u32>(asset_manager->total_opaque_mesh_count));
         // ImGui::Text("Masked Mesh Count: %u", s_cast<u32>(asset_manager->total_masked_mesh_count));
@@ -311,6 +325,52 @@ namespace foundation {
         // ImGui::Text("Vertex Count: %zu", asset_manager->total_vertex_count);
         ImGui::End();
 
+        ImGui::Begin("Thread Pool Statistics");
+        {
+            static constexpr std::array<const char*, TASK_CLASS_COUNT> task_class_names = { "Compute", "IO", "Latency Critical" };
+            const ThreadPoolStatistics statistics = thread_pool->statistics();
+            for(usize class_index = 0; class_index < TASK_CLASS_COUNT; class_index++) {
+                ImGui::Text("%s Queued: %u (injector high %u, low %u)", task_class_names[class_index], statistics.queued_entries[class_index], statistics.injector_depth[class_index][0], statistics.injector_depth[class_index][1]);
+            }
+            ImGui::Text("Dropped Chunks: %llu", s_cast<unsigned long long>(statistics.dropped_chunks));
+
+            if (ImGui::BeginTable("Workers", 8, ImGuiTableFlags_SizingFixedFit | ImGuiTableFlags_Borders | ImGuiTableFlags_RowBg)) {
+                ImGui::TableSetupColumn("Worker", {});
+                ImGui::TableSetupColumn("Class", {});
+                ImGui::TableSetupColumn("Executed", {});
+                ImGui::TableSetupColumn("Steals", {});
+                ImGui::TableSetupColumn("Busy", {});
+                ImGui::TableSetupColumn("Utilization", {});
+                ImGui::TableSetupColumn("Lock Wait", {});
+                ImGui::TableSetupColumn("Queue High/Low", {});
+                ImGui::TableHeadersRow();
+                for(usize worker_index = 0; worker_index < statistics.workers.size(); worker_index++) {
+                    const ThreadPoolWorkerStatistics& worker = statistics.workers[worker_index];
+                    const f64 tracked_ms = worker.busy_ms + worker.idle_ms;
+
+                    ImGui::TableNextRow();
+                    ImGui::TableSetColumnIndex(0);
+                    ImGui::Text("%zu", worker_index);
+                    ImGui::TableSetColumnIndex(1);
+                    ImGui::Text("%s", task_class_names[s_cast<usize>(worker.task_class)]);
+                    ImGui::TableSetColumnIndex(2);
+                    ImGui::Text("%llu", s_cast<unsigned long long>(worker.executed_entries));
+                    ImGui::TableSetColumnIndex(3);
+                    ImGui::Text("%llu", s_cast<unsigned long long>(worker.steals));
+                    ImGui::TableSetColumnIndex(4);
+                    ImGui::Text("%.1fms", worker.busy_ms);
+                    ImGui::TableSetColumnIndex(5);
+                    ImGui::Text("%.1f%%", tracked_ms > 0.0 ? 100.0 * worker.busy_ms / tracked_ms : 0.0);
+                    ImGui::TableSetColumnIndex(6);
+                    ImGui::Text("%.3fms", worker.injector_lock_wait_ms);
+                    ImGui::TableSetColumnIndex(7);
+                    ImGui::Text("%u/%u", worker.queue_depth[0], worker.queue_depth[1]);
+                }
+                ImGui::EndTable();
+            }
+        }
+        ImGui::End();
+
         scene_hierarchy_panel.draw();
         renderer->ui_update();
         viewport_panel.selected_entity = scene_hierarchy_panel.selected_entity;
@@ -0,0 +1,233 @@
+#include <ecs/asset_converter.hpp>
+#include <common/memory_usage.hpp>
+#include <utils/file_io.hpp>
+#include <fastgltf/core.hpp>
+#include <charconv>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+// times AssetConverter::process_mesh, meshlets and the whole lod dag, on a generated grid
+//
+// usage: foundation_mesh_bench [options]
+//   --grid <quads>     quads along each side of the grid, two triangles each, defaults to 708 for about a million triangles
+//   --repeats <count>  runs on the same asset, the fastest one is reported, defaults to 3
+//   --workers <count>  compute workers of the thread pool, defaults to one per hardware thread
+//
+// the grid is written as .gltf and .bin into the temp directory and parsed like the converter does, so accessor
+// loading is part of every run. every repeat runs once with the lod arenas and once with their temporaries sent to
+// new/delete, see ProcessMeshInfo::use_arenas
+
+using namespace foundation;
+
+struct BenchSettings {
+    u32 grid_size = 708;
+    u32 repeat_count = 3;
+    std::optional<u32> worker_count = std::nullopt;
+};
+
+static void print_usage() {
+    fmt::println("usage: foundation_mesh_bench [--grid <quads>] [--repeats <count>] [--workers <count>]");
+}
+
+// the whole value has to be a number that fits into u32, zero is raised to one
+static auto parse_count(std::string_view value) -> std::optional<u32> {
+    u32 count = 0;
+    auto const [end, error] = std::from_chars(value.data(), value.data() + value.size(), count);
+    if(error != std::errc{} || end != value.data() + value.size()) { return std::nullopt; }
+    return std::max(count, 1u);
+}
+
+template<typename T>
+static void append_bytes(std::vector<std::byte>& bytes, const std::vector<T>& values) {
+    usize const offset = bytes.size();
+    bytes.resize(offset + values.size() * sizeof(T));
+    std::memcpy(bytes.data() + offset, values.data(), values.size() * sizeof(T));
+}
+
+// unit grid in xz with a few low hills so simplification has curvature to preserve, returns the path of the .gltf
+static auto write_grid(const std::filesystem::path& directory, u32 grid_size) -> std::filesystem::path {
+    u32 const side = grid_size + 1;
+    auto height = [](f32 x, f32 z) -> f32 { return 0.05f * std::sin(x * 12.0f) * std::cos(z * 9.0f); };
+
+    std::vector<f32vec3> positions = {};
+    std::vector<f32vec3> normals = {};
+    std::vector<f32vec2> uvs = {};
+    positions.reserve(s_cast<usize>(side) * side);
+    normals.reserve(s_cast<usize>(side) * side);
+    uvs.reserve(s_cast<usize>(side) * side);
+    for(u32 z = 0; z < side; z++) {
+        for(u32 x = 0; x < side; x++) {
+            f32 const u = s_cast<f32>(x) / s_cast<f32>(grid_size);
+            f32 const v = s_cast<f32>(z) / s_cast<f32>(grid_size);
+            positions.push_back({ u, height(u, v), v });
+            // central differences of the height field
+            f32 const epsilon = 1.0f / s_cast<f32>(grid_size);
+            f32 const dx = (height(u + epsilon, v) - height(u - epsilon, v)) / (2.0f * epsilon);
+            f32 const dz = (height(u, v + epsilon) - height(u, v - epsilon)) / (2.0f * epsilon);
+            normals.push_back(glm::normalize(f32vec3{ -dx, 1.0f, -dz }));
+            uvs.push_back({ u, v });
+        }
+    }
+
+    std::vector<u32> indices = {};
+    indices.reserve(s_cast<usize>(grid_size) * grid_size * 6);
+    for(u32 z = 0; z < grid_size; z++) {
+        for(u32 x = 0; x < grid_size; x++) {
+            u32 const corner = z * side + x;
+            indices.insert(indices.end(), { corner, corner + side, corner + 1, corner + 1, corner + side, corner + side + 1 });
+        }
+    }
+
+    std::vector<std::byte> buffer = {};
+    append_bytes(buffer, positions);
+    append_bytes(buffer, normals);
+    append_bytes(buffer, uvs);
+    append_bytes(buffer, indices);
+    write_bytes_to_file(buffer, directory / "grid.bin");
+
+    usize const position_bytes = positions.size() * sizeof(f32vec3);
+    usize const normal_bytes = normals.size() * sizeof(f32vec3);
+    usize const uv_bytes = uvs.size() * sizeof(f32vec2);
+    usize const index_bytes = indices.size() * sizeof(u32);
+    f32 const max_height = 0.05f;
+    std::string const gltf = fmt::format(R"({{
+    "asset": {{ "version": "2.0" }},
+    "buffers": [{{ "uri": "grid.bin", "byteLength": {} }}],
+    "bufferViews": [
+        {{ "buffer": 0, "byteOffset": 0, "byteLength": {} }},
+        {{ "buffer": 0, "byteOffset": {}, "byteLength": {} }},
+        {{ "buffer": 0, "byteOffset": {}, "byteLength": {} }},
+        {{ "buffer": 0, "byteOffset": {}, "byteLength": {} }}
+    ],
+    "accessors": [
+        {{ "bufferView": 0, "componentType": 5126, "count": {}, "type": "VEC3", "min": [0.0, {}, 0.0], "max": [1.0, {}, 1.0] }},
+        {{ "bufferView": 1, "componentType": 5126, "count": {}, "type": "VEC3" }},
+        {{ "bufferView": 2, "componentType": 5126, "count": {}, "type": "VEC2" }},
+        {{ "bufferView": 3, "componentType": 5125, "count": {}, "type": "SCALAR" }}
+    ],
+    "meshes": [{{ "primitives": [{{ "attributes": {{ "POSITION": 0, "NORMAL": 1, "TEXCOORD_0": 2 }}, "indices": 3 }}] }}]
+}})",
+        buffer.size(),
+        position_bytes,
+        position_bytes, normal_bytes,
+        position_bytes + normal_bytes, uv_bytes,
+        position_bytes + normal_bytes + uv_bytes, index_bytes,
+        positions.size(), -max_height, max_height,
+        normals.size(),
+        uvs.size(),
+        indices.size());
+
+    std::filesystem::path const gltf_path = directory / "grid.gltf";
+    std::span<const std::byte> const gltf_bytes = std::as_bytes(std::span{gltf});
+    write_bytes_to_file(std::vector<std::byte>(gltf_bytes.begin(), gltf_bytes.end()), gltf_path);
+    return gltf_path;
+}
+
+auto main(i32 argc, char** argv) -> i32 {
+    BenchSettings settings = {};
+
+    for(i32 i = 1; i < argc; i++) {
+        std::string_view const arg = argv[i];
+        bool const has_value = i + 1 < argc;
+
+        if(arg == "--help" || arg == "-h") {
+            print_usage();
+            return 0;
+        }
+        if(!has_value || (arg != "--grid" && arg != "--repeats" && arg != "--workers")) {
+            fmt::println("unknown option: {}", arg);
+            print_usage();
+            return 1;
+        }
+
+        std::optional<u32> const count = parse_count(argv[++i]);
+        if(!count.has_value()) {
+            fmt::println("invalid value for {}: {}", arg, argv[i]);
+            print_usage();
+            return 1;
+        }
+
+        if(arg == "--grid") {
+            settings.grid_size = count.value();
+        } else if(arg == "--repeats") {
+            settings.repeat_count = count.value();
+        } else {
+            settings.worker_count = count;
+        }
+    }
+
+    std::filesystem::path const directory = std::filesystem::temp_directory_path() / "foundation_mesh_bench";
+    std::filesystem::create_directories(directory);
+    std::filesystem::path const gltf_path = write_grid(directory, settings.grid_size);
+
+    fastgltf::Parser parser{};
+    auto mapped_file = fastgltf::MappedGltfFile::FromPath(gltf_path);
+    if(mapped_file.error() != fastgltf::Error::None) {
+        fmt::println("couldnt map {}", gltf_path.string());
+        return 1;
+    }
+    auto loaded_asset = parser.loadGltf(mapped_file.get(), directory, fastgltf::Options::LoadExternalBuffers);
+    if(loaded_asset.error() != fastgltf::Error::None) {
+        fmt::println("couldnt parse {}", gltf_path.string());
+        return 1;
+    }
+    fastgltf::Asset asset = std::move(loaded_asset.get());
+
+    ThreadPool thread_pool(ThreadPoolInfo {
+        .compute_thread_count = settings.worker_count,
+        .io_thread_count = 0,
+        .latency_critical_thread_count = 0,
+    });
+
+    u64 const triangle_count = u64{2} * settings.grid_size * settings.grid_size;
+    fmt::println("{}x{} grid, {} triangles, {} workers, best of {} runs", settings.grid_size, settings.grid_size, triangle_count, thread_pool.worker_count(), settings.repeat_count);
+    fmt::println("");
+    fmt::println("{:>4}  {:>6}  {:>10}  {:>10}  {:>14}", "run", "arenas", "ms", "meshlets", "peak rss MiB");
+
+    struct ModeResult {
+        f64 best_ms = std::numeric_limits<f64>::max();
+        std::optional<u64> max_peak_resident_bytes = std::nullopt;
+    };
+    // indexed by use_arenas, both modes run in every repeat so drift over time hits them alike
+    std::array<ModeResult, 2> mode_results = {};
+
+    for(u32 repeat = 0; repeat < settings.repeat_count; repeat++) {
+        for(bool const use_arenas : { true, false }) {
+#if defined(__GLIBC__)
+            // hands freed heap back to the os, otherwise the peak of a run starts from whatever the previous one left resident
+            malloc_trim(0);
+#endif
+            reset_peak_resident_bytes();
+            auto const start_time = std::chrono::steady_clock::now();
+            ProcessedMeshInfo const processed_mesh = AssetConverter::process_mesh(ProcessMeshInfo {
+                .asset = &asset,
+                .gltf_mesh_index = 0,
+                .gltf_primitive_index = 0,
+                .thread_pool = &thread_pool,
+                .asset_directory = directory,
+                .use_arenas = use_arenas,
+            });
+            f64 const elapsed_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+            std::optional<u64> const peak_resident_bytes = query_peak_resident_bytes();
+
+            ModeResult& mode_result = mode_results[use_arenas ? 1 : 0];
+            mode_result.best_ms = std::min(mode_result.best_ms, elapsed_ms);
+            if(peak_resident_bytes.has_value()) {
+                mode_result.max_peak_resident_bytes = std::max(mode_result.max_peak_resident_bytes.value_or(0), peak_resident_bytes.value());
+            }
+
+            fmt::println("{:>4}  {:>6}  {:>10.1f}  {:>10}  {:>14}", repeat, use_arenas ? "on" : "off", elapsed_ms, processed_mesh.meshlets.size(),
+                peak_resident_bytes.has_value() ? std::to_string(peak_resident_bytes.value() >> 20) : std::string{"n/a"});
+        }
+    }
+
+    fmt::println("");
+    for(bool const use_arenas : { true, false }) {
+        const ModeResult& mode_result = mode_results[use_arenas ? 1 : 0];
+        fmt::println("arenas {:<3}  best {:.1f} ms, {:.2f} Mtri/s, peak rss {} MiB", use_arenas ? "on" : "off",
+            mode_result.best_ms, s_cast<f64>(triangle_count) / (mode_result.best_ms * 1000.0),
+            mode_result.max_peak_resident_bytes.has_value() ? std::to_string(mode_result.max_peak_resident_bytes.value() >> 20) : std::string{"n/a"});
+    }
+    return 0;
+}
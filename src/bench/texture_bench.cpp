@@ -0,0 +1,271 @@
+#include <common/thread_pool.hpp>
+#include <utils/block_compression.hpp>
+#include <utils/pixel_kernels.hpp>
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <charconv>
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wold-style-cast"
+#include <nvtt/nvtt.h>
+#pragma clang diagnostic pop
+#endif
+
+// compresses every image of a directory with nvtt and with the native encoders and prints quality next to throughput,
+// only the top mip of bc1, bc4 and bc5 is measured since those are the formats both encoders can produce
+//
+// usage: foundation_texture_bench [options] <image directory>
+//   --repeats <count>  encodes per image and format, the fastest one is reported, defaults to 3
+//   --workers <count>  compute workers the native encoders spread blocks over, defaults to one per hardware thread
+//
+// nvtt runs with the same context and quality as the cooker, so with cuda available it is measured on the gpu.
+// preparing the input of an encoder isnt timed, psnr compares the decoded blocks with the channels the format stores
+
+using namespace foundation;
+
+static constexpr std::array<u8, 4> BGRA_FROM_RGBA = { 2, 1, 0, 3 };
+
+struct BenchSettings {
+    u32 repeat_count = 3;
+    std::optional<u32> worker_count = std::nullopt;
+    std::filesystem::path image_directory = {};
+};
+
+struct BenchFormat {
+    std::string_view name = {};
+    nvtt::Format nvtt_format = {};
+    // channels of the rgba source the format stores, in the order it stores them
+    std::array<u32, 3> reference_channels = {};
+    u32 reference_channel_count = {};
+};
+
+static constexpr std::array<BenchFormat, 3> BENCH_FORMATS = {
+    BenchFormat { .name = "bc1", .nvtt_format = nvtt::Format_BC1, .reference_channels = { 0, 1, 2 }, .reference_channel_count = 3 },
+    BenchFormat { .name = "bc4", .nvtt_format = nvtt::Format_BC4, .reference_channels = { 0 }, .reference_channel_count = 1 },
+    BenchFormat { .name = "bc5", .nvtt_format = nvtt::Format_BC5, .reference_channels = { 0, 1 }, .reference_channel_count = 2 },
+};
+
+struct EncodeResult {
+    f64 best_ms = std::numeric_limits<f64>::max();
+    f64 psnr = {};
+};
+
+// totals of one encoder and format over every image
+struct EncoderTotals {
+    u64 pixel_count = {};
+    f64 elapsed_ms = {};
+    f64 psnr_sum = {};
+    u32 image_count = {};
+};
+
+struct OutputHandler : public nvtt::OutputHandler {
+    void beginImage(i32 size, i32 /*width*/, i32 /*height*/, i32 /*depth*/, i32 /*face*/, i32 /*miplevel*/) override {
+        data.resize(s_cast<usize>(size));
+        written = 0;
+    }
+    auto writeData(const void* ptr, i32 size) -> bool override {
+        std::memcpy(data.data() + written, ptr, s_cast<usize>(size));
+        written += s_cast<usize>(size);
+        return true;
+    }
+    void endImage() override {}
+
+    std::vector<std::byte> data = {};
+    usize written = {};
+};
+
+static void print_usage() {
+    fmt::println("usage: foundation_texture_bench [--repeats <count>] [--workers <count>] <image directory>");
+}
+
+// the whole value has to be a number that fits into u32, zero is raised to one
+static auto parse_count(std::string_view value) -> std::optional<u32> {
+    u32 count = 0;
+    auto const [end, error] = std::from_chars(value.data(), value.data() + value.size(), count);
+    if(error != std::errc{} || end != value.data() + value.size()) { return std::nullopt; }
+    return std::max(count, 1u);
+}
+
+template<typename Fn>
+static auto measure_best_ms(u32 repeat_count, std::vector<std::byte>& blocks, Fn&& encode) -> f64 {
+    f64 best_ms = std::numeric_limits<f64>::max();
+    for(u32 repeat = 0; repeat < repeat_count; repeat++) {
+        auto const start_time = std::chrono::steady_clock::now();
+        blocks = encode();
+        best_ms = std::min(best_ms, std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start_time).count());
+    }
+    return best_ms;
+}
+
+static auto measure_psnr(const BenchFormat& format, std::span<const std::byte> blocks, std::span<const std::byte> reference_rgba, u32 width, u32 height) -> f64 {
+    std::vector<std::byte> decoded = {};
+    usize decoded_channel_count = 0;
+    if(format.nvtt_format == nvtt::Format_BC1) { decoded = decode_bc1(blocks, width, height); decoded_channel_count = 4; }
+    else if(format.nvtt_format == nvtt::Format_BC4) { decoded = decode_bc4(blocks, width, height); decoded_channel_count = 1; }
+    else { decoded = decode_bc5(blocks, width, height); decoded_channel_count = 2; }
+
+    usize const pixel_count = usize{width} * height;
+    f64 squared_error = 0.0;
+    for(usize pixel = 0; pixel < pixel_count; pixel++) {
+        for(u32 channel = 0; channel < format.reference_channel_count; channel++) {
+            f64 const difference = s_cast<f64>(decoded[pixel * decoded_channel_count + channel]) - s_cast<f64>(reference_rgba[pixel * 4 + format.reference_channels[channel]]);
+            squared_error += difference * difference;
+        }
+    }
+
+    f64 const mean_squared_error = squared_error / s_cast<f64>(pixel_count * format.reference_channel_count);
+    if(mean_squared_error == 0.0) { return std::numeric_limits<f64>::infinity(); }
+    return 10.0 * std::log10(255.0 * 255.0 / mean_squared_error);
+}
+
+auto main(i32 argc, char** argv) -> i32 {
+    BenchSettings settings = {};
+
+    for(i32 i = 1; i < argc; i++) {
+        std::string_view const arg = argv[i];
+        bool const has_value = i + 1 < argc;
+
+        if(arg == "--help" || arg == "-h") {
+            print_usage();
+            return 0;
+        }
+        if(!arg.starts_with("--")) {
+            settings.image_directory = std::filesystem::path(arg);
+            continue;
+        }
+        if(!has_value || (arg != "--repeats" && arg != "--workers")) {
+            fmt::println("unknown option: {}", arg);
+            print_usage();
+            return 1;
+        }
+
+        std::optional<u32> const count = parse_count(argv[++i]);
+        if(!count.has_value()) {
+            fmt::println("invalid value for {}: {}", arg, argv[i]);
+            print_usage();
+            return 1;
+        }
+
+        if(arg == "--repeats") {
+            settings.repeat_count = count.value();
+        } else {
+            settings.worker_count = count;
+        }
+    }
+
+    if(settings.image_directory.empty() || !std::filesystem::is_directory(settings.image_directory)) {
+        print_usage();
+        return 1;
+    }
+
+    // sorted so runs over the same directory line up
+    std::vector<std::filesystem::path> image_paths = {};
+    for(const auto& entry : std::filesystem::directory_iterator(settings.image_directory)) {
+        if(entry.is_regular_file()) { image_paths.push_back(entry.path()); }
+    }
+    std::ranges::sort(image_paths);
+
+    ThreadPool thread_pool(ThreadPoolInfo {
+        .compute_thread_count = settings.worker_count,
+        .io_thread_count = 0,
+        .latency_critical_thread_count = 0,
+    });
+    nvtt::Context context(true);
+
+    fmt::println("nvtt {} cuda, native on {} workers with {} pixel kernels, best of {} runs", context.isCudaAccelerationEnabled() ? "with" : "without",
+        thread_pool.worker_count(), pixel_kernels_instruction_set(), settings.repeat_count);
+    fmt::println("");
+    fmt::println("{:<32}  {:>6}  {:>9}  {:>12}  {:>9}  {:>12}", "image", "format", "nvtt dB", "nvtt Mpix/s", "native dB", "native Mpix/s");
+
+    // indexed by format and then encoder, nvtt first
+    std::array<std::array<EncoderTotals, 2>, BENCH_FORMATS.size()> totals = {};
+
+    for(const std::filesystem::path& image_path : image_paths) {
+        i32 width = 0;
+        i32 height = 0;
+        i32 channel_count = 0;
+        u8* image_data = stbi_load(image_path.string().c_str(), &width, &height, &channel_count, 4);
+        if(image_data == nullptr) {
+            fmt::println("skipping {}: {}", image_path.filename().string(), stbi_failure_reason());
+            continue;
+        }
+        std::vector<std::byte> rgba(s_cast<usize>(width) * s_cast<usize>(height) * 4);
+        std::memcpy(rgba.data(), image_data, rgba.size());
+        stbi_image_free(image_data);
+
+        u32 const image_width = s_cast<u32>(width);
+        u32 const image_height = s_cast<u32>(height);
+        usize const pixel_count = rgba.size() / 4;
+
+        // nvtt takes bgra, bc1 gets it opaque like the cooker does for albedo
+        std::vector<std::byte> bgra(rgba.size());
+        swizzle_rgba8(rgba, bgra, BGRA_FROM_RGBA);
+        std::vector<std::byte> opaque_bgra = bgra;
+        fill_channel_rgba8(opaque_bgra, 3, std::byte{255});
+        std::vector<std::byte> red_plane(pixel_count);
+        extract_channel_rgba8(rgba, red_plane, 0);
+        std::vector<std::byte> const zero_plane(pixel_count);
+
+        for(usize format_index = 0; format_index < BENCH_FORMATS.size(); format_index++) {
+            const BenchFormat& format = BENCH_FORMATS[format_index];
+
+            nvtt::Surface nvtt_image;
+            if(format.nvtt_format == nvtt::Format_BC4) {
+                nvtt_image.setImage(nvtt::InputFormat_BGRA_8UB, width, height, 1, red_plane.data(), zero_plane.data(), zero_plane.data(), zero_plane.data());
+            } else {
+                nvtt_image.setImage(nvtt::InputFormat_BGRA_8UB, width, height, 1, (format.nvtt_format == nvtt::Format_BC1 ? opaque_bgra : bgra).data());
+            }
+            nvtt::CompressionOptions compression_options = {};
+            compression_options.setFormat(format.nvtt_format);
+            compression_options.setQuality(nvtt::Quality_Normal);
+            OutputHandler output_handler = {};
+            nvtt::OutputOptions output_options = {};
+            output_options.setOutputHandler(&output_handler);
+
+            std::vector<std::byte> nvtt_blocks = {};
+            EncodeResult nvtt_result = {};
+            nvtt_result.best_ms = measure_best_ms(settings.repeat_count, nvtt_blocks, [&]() {
+                context.compress(nvtt_image, 0, 0, compression_options, output_options);
+                return output_handler.data;
+            });
+            nvtt_result.psnr = measure_psnr(format, nvtt_blocks, rgba, image_width, image_height);
+
+            std::vector<std::byte> native_blocks = {};
+            EncodeResult native_result = {};
+            native_result.best_ms = measure_best_ms(settings.repeat_count, native_blocks, [&]() {
+                if(format.nvtt_format == nvtt::Format_BC1) { return encode_bc1(rgba, image_width, image_height, &thread_pool); }
+                if(format.nvtt_format == nvtt::Format_BC4) { return encode_bc4(red_plane, image_width, image_height, &thread_pool); }
+                return encode_bc5(rgba, image_width, image_height, &thread_pool);
+            });
+            native_result.psnr = measure_psnr(format, native_blocks, rgba, image_width, image_height);
+
+            std::array<EncodeResult, 2> const results = { nvtt_result, native_result };
+            for(usize encoder = 0; encoder < results.size(); encoder++) {
+                EncoderTotals& encoder_totals = totals[format_index][encoder];
+                encoder_totals.pixel_count += pixel_count;
+                encoder_totals.elapsed_ms += results[encoder].best_ms;
+                encoder_totals.psnr_sum += results[encoder].psnr;
+                encoder_totals.image_count++;
+            }
+
+            fmt::println("{:<32}  {:>6}  {:>9.2f}  {:>12.1f}  {:>9.2f}  {:>12.1f}", image_path.filename().string(), format.name,
+                nvtt_result.psnr, s_cast<f64>(pixel_count) / (nvtt_result.best_ms * 1000.0),
+                native_result.psnr, s_cast<f64>(pixel_count) / (native_result.best_ms * 1000.0));
+        }
+    }
+
+    // psnr is averaged per image, throughput is over every pixel of the set
+    fmt::println("");
+    for(usize format_index = 0; format_index < BENCH_FORMATS.size(); format_index++) {
+        const std::array<EncoderTotals, 2>& format_totals = totals[format_index];
+        if(format_totals[0].image_count == 0) { continue; }
+        auto mean_psnr = [](const EncoderTotals& encoder_totals) { return encoder_totals.psnr_sum / s_cast<f64>(encoder_totals.image_count); };
+        auto throughput = [](const EncoderTotals& encoder_totals) { return s_cast<f64>(encoder_totals.pixel_count) / (encoder_totals.elapsed_ms * 1000.0); };
+        fmt::println("{:<32}  {:>6}  {:>9.2f}  {:>12.1f}  {:>9.2f}  {:>12.1f}", "all images", BENCH_FORMATS[format_index].name,
+            mean_psnr(format_totals[0]), throughput(format_totals[0]),
+            mean_psnr(format_totals[1]), throughput(format_totals[1]));
+    }
+
+    return 0;
+}
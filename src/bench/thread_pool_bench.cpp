@@ -0,0 +1,175 @@
+#include <common/thread_pool.hpp>
+#include <charconv>
+
+// measures how chunk throughput of the thread pool scales with the number of compute workers
+//
+// usage: foundation_thread_pool_bench [options]
+//   --chunks <count>       chunks per run, defaults to 262144
+//   --work <iterations>    busy loop iterations inside every chunk, smaller values stress the scheduler more, defaults to 1000
+//   --repeats <count>      runs per worker count, the fastest one is reported, defaults to 5
+//   --max-workers <count>  largest worker count measured, defaults to one per hardware thread
+//
+// every worker count runs two workloads, one task with many chunks through blocking_dispatch
+// and as many single chunk tasks submitted from the calling thread like the asset loaders do,
+// the calling thread takes part in blocking_dispatch so the chunked workload runs on one thread more than listed
+
+using namespace foundation;
+
+struct BenchSettings {
+    u32 chunk_count = 1u << 18u;
+    u32 work_iterations = 1000;
+    u32 repeat_count = 5;
+    u32 max_worker_count = std::max(std::thread::hardware_concurrency(), 1u);
+};
+
+struct BenchResult {
+    f64 chunked_ms = {};
+    f64 submitted_ms = {};
+    u64 steals = {};
+};
+
+static void print_usage() {
+    fmt::println("usage: foundation_thread_pool_bench [--chunks <count>] [--work <iterations>] [--repeats <count>] [--max-workers <count>]");
+}
+
+// the whole value has to be a number that fits into u32, zero is raised to one
+static auto parse_count(std::string_view value) -> std::optional<u32> {
+    u32 count = 0;
+    auto const [end, error] = std::from_chars(value.data(), value.data() + value.size(), count);
+    if(error != std::errc{} || end != value.data() + value.size()) { return std::nullopt; }
+    return std::max(count, 1u);
+}
+
+// xorshift so the compiler cant fold the loop, the result is stored per chunk to keep it alive
+static auto spin(u64 seed, u32 iterations) -> u64 {
+    u64 state = seed | 1;
+    for(u32 i = 0; i < iterations; i++) {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+    }
+    return state;
+}
+
+struct SpinTask : Task {
+    std::vector<u64>* results = {};
+    u32 work_iterations = {};
+    SpinTask(std::vector<u64>* _results, u32 _work_iterations)
+        : results{_results}, work_iterations{_work_iterations} { chunk_count = s_cast<u32>(_results->size()); }
+
+    void callback(u32 chunk_index, u32 /*thread_index*/) override {
+        (*results)[chunk_index] = spin(chunk_index, work_iterations);
+    }
+};
+
+template<typename Fn>
+static auto measure_best_ms(u32 repeat_count, Fn&& fn) -> f64 {
+    f64 best_ms = std::numeric_limits<f64>::max();
+    for(u32 repeat = 0; repeat < repeat_count; repeat++) {
+        auto const start_time = std::chrono::steady_clock::now();
+        fn();
+        best_ms = std::min(best_ms, std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start_time).count());
+    }
+    return best_ms;
+}
+
+static auto run_bench(const BenchSettings& settings, u32 worker_count) -> BenchResult {
+    // declared before the pool so it outlives the workers, the last one may still be notifying when wait returns
+    std::atomic<u32> unfinished_submits = {};
+    ThreadPool thread_pool(ThreadPoolInfo {
+        .compute_thread_count = worker_count,
+        .io_thread_count = 0,
+        .latency_critical_thread_count = 0,
+    });
+
+    std::vector<u64> results(settings.chunk_count);
+    BenchResult result = {};
+
+    // warm up once so thread start and the first touch of the results dont end up in the numbers
+    thread_pool.blocking_dispatch(std::make_shared<SpinTask>(&results, settings.work_iterations));
+
+    result.chunked_ms = measure_best_ms(settings.repeat_count, [&]() {
+        thread_pool.blocking_dispatch(std::make_shared<SpinTask>(&results, settings.work_iterations));
+    });
+
+    result.submitted_ms = measure_best_ms(settings.repeat_count, [&]() {
+        unfinished_submits.store(settings.chunk_count, std::memory_order_relaxed);
+        for(u32 chunk_index = 0; chunk_index < settings.chunk_count; chunk_index++) {
+            thread_pool.submit([&results, &unfinished_submits, chunk_index, work_iterations = settings.work_iterations]() {
+                results[chunk_index] = spin(chunk_index, work_iterations);
+                if(unfinished_submits.fetch_sub(1, std::memory_order_acq_rel) == 1) { unfinished_submits.notify_all(); }
+            });
+        }
+        for(u32 unfinished = unfinished_submits.load(std::memory_order_acquire); unfinished != 0; unfinished = unfinished_submits.load(std::memory_order_acquire)) {
+            unfinished_submits.wait(unfinished, std::memory_order_acquire);
+        }
+    });
+
+    for(const ThreadPoolWorkerStatistics& worker : thread_pool.statistics().workers) {
+        if(worker.task_class == TaskClass::COMPUTE) { result.steals += worker.steals; }
+    }
+
+    return result;
+}
+
+auto main(i32 argc, char** argv) -> i32 {
+    BenchSettings settings = {};
+
+    for(i32 i = 1; i < argc; i++) {
+        std::string_view const arg = argv[i];
+        bool const has_value = i + 1 < argc;
+
+        u32* target = nullptr;
+        if(arg == "--chunks" && has_value) {
+            target = &settings.chunk_count;
+        } else if(arg == "--work" && has_value) {
+            target = &settings.work_iterations;
+        } else if(arg == "--repeats" && has_value) {
+            target = &settings.repeat_count;
+        } else if(arg == "--max-workers" && has_value) {
+            target = &settings.max_worker_count;
+        } else if(arg == "--help" || arg == "-h") {
+            print_usage();
+            return 0;
+        } else {
+            fmt::println("unknown option: {}", arg);
+            print_usage();
+            return 1;
+        }
+
+        std::optional<u32> const count = parse_count(argv[++i]);
+        if(!count.has_value()) {
+            fmt::println("invalid value for {}: {}", arg, argv[i]);
+            print_usage();
+            return 1;
+        }
+        *target = count.value();
+    }
+
+    // powers of two and the maximum itself
+    std::vector<u32> worker_counts = {};
+    for(u32 worker_count = 1; worker_count < settings.max_worker_count; worker_count *= 2) {
+        worker_counts.push_back(worker_count);
+    }
+    worker_counts.push_back(settings.max_worker_count);
+
+    fmt::println("{} chunks of {} iterations, best of {} runs", settings.chunk_count, settings.work_iterations, settings.repeat_count);
+    fmt::println("");
+    fmt::println("{:>8}  {:>14}  {:>8}  {:>14}  {:>8}  {:>10}", "workers", "chunked Mc/s", "speedup", "submitted Mc/s", "speedup", "steals");
+
+    std::optional<BenchResult> baseline = std::nullopt;
+    for(u32 worker_count : worker_counts) {
+        BenchResult const result = run_bench(settings, worker_count);
+        if(!baseline.has_value()) { baseline = result; }
+
+        f64 const chunked_throughput = s_cast<f64>(settings.chunk_count) / (result.chunked_ms * 1000.0);
+        f64 const submitted_throughput = s_cast<f64>(settings.chunk_count) / (result.submitted_ms * 1000.0);
+        fmt::println("{:>8}  {:>14.2f}  {:>7.2f}x  {:>14.2f}  {:>7.2f}x  {:>10}",
+            worker_count,
+            chunked_throughput, baseline->chunked_ms / result.chunked_ms,
+            submitted_throughput, baseline->submitted_ms / result.submitted_ms,
+            result.steals);
+    }
+
+    return 0;
+}
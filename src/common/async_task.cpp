@@ -0,0 +1,50 @@
+#include "async_task.hpp"
+#include <utils/file_io.hpp>
+
+namespace foundation {
+    void spawn(ThreadPool* thread_pool, AsyncTask<> task, TaskPriority priority, TaskClass task_class) {
+        auto handle = task.release();
+        handle.promise().detached = true;
+        thread_pool->submit([handle]() { handle.resume(); }, priority, task_class);
+    }
+
+    auto read_file_async(ThreadPool* thread_pool, std::filesystem::path file_path) -> AsyncTask<std::vector<std::byte>> {
+        co_await schedule_on(thread_pool, TaskClass::IO);
+        std::vector<std::byte> data = read_file_to_bytes(file_path);
+        co_await schedule_on(thread_pool, TaskClass::COMPUTE);
+        co_return data;
+    }
+
+    void TimelineWaitList::Awaiter::await_suspend(std::coroutine_handle<> handle) {
+        entry.handle = handle;
+        std::lock_guard lock{wait_list->mutex};
+        wait_list->entries.push_back(std::move(entry));
+    }
+
+    auto TimelineWaitList::wait(ThreadPool* thread_pool, daxa::TimelineSemaphore semaphore, u64 value) -> Awaiter {
+        return Awaiter {
+            .wait_list = this,
+            .entry = {
+                .semaphore = std::move(semaphore),
+                .value = value,
+                .handle = {},
+                .thread_pool = thread_pool,
+            },
+        };
+    }
+
+    void TimelineWaitList::poll() {
+        PROFILE_SCOPE;
+        std::vector<Entry> ready_entries = {};
+        {
+            std::lock_guard lock{mutex};
+            auto ready_begin = std::partition(entries.begin(), entries.end(), [](const Entry& entry) { return entry.semaphore.value() < entry.value; });
+            std::move(ready_begin, entries.end(), std::back_inserter(ready_entries));
+            entries.erase(ready_begin, entries.end());
+        }
+
+        for(const Entry& entry : ready_entries) {
+            entry.thread_pool->submit([handle = entry.handle]() { handle.resume(); });
+        }
+    }
+}
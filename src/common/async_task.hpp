@@ -0,0 +1,155 @@
+#pragma once
+#include <coroutine>
+#include <exception>
+#include "common/thread_pool.hpp"
+
+namespace foundation {
+    template<typename T = void>
+    struct AsyncTask;
+
+    struct AsyncPromiseBase {
+        // resumed once the coroutine finished, set when another coroutine awaits this one
+        std::coroutine_handle<> continuation = {};
+        // spawned coroutines nobody awaits free their own frame at the end
+        bool detached = false;
+        std::exception_ptr exception = {};
+
+        struct FinalAwaiter {
+            auto await_ready() const noexcept -> bool { return false; }
+
+            template<typename Promise>
+            auto await_suspend(std::coroutine_handle<Promise> handle) noexcept -> std::coroutine_handle<> {
+                AsyncPromiseBase& promise = handle.promise();
+                if(promise.continuation) { return promise.continuation; }
+                if(promise.detached) { handle.destroy(); }
+                return std::noop_coroutine();
+            }
+
+            void await_resume() const noexcept {}
+        };
+
+        auto initial_suspend() noexcept -> std::suspend_always { return {}; }
+        auto final_suspend() noexcept -> FinalAwaiter { return {}; }
+
+        void unhandled_exception() {
+            // nobody is around to observe it, same as an exception escaping a worker thread
+            if(detached) { std::terminate(); }
+            exception = std::current_exception();
+        }
+    };
+
+    template<typename T>
+    struct AsyncPromise : AsyncPromiseBase {
+        std::optional<T> value = {};
+
+        auto get_return_object() -> AsyncTask<T>;
+        void return_value(T result) { value.emplace(std::move(result)); }
+    };
+
+    template<>
+    struct AsyncPromise<void> : AsyncPromiseBase {
+        auto get_return_object() -> AsyncTask<void>;
+        void return_void() {}
+    };
+
+    // lazily started coroutine, runs once it is awaited or handed to spawn
+    template<typename T>
+    struct AsyncTask {
+        using promise_type = AsyncPromise<T>;
+        using Handle = std::coroutine_handle<promise_type>;
+
+        AsyncTask() = default;
+        explicit AsyncTask(Handle _handle) : handle{_handle} {}
+        AsyncTask(AsyncTask&& other) noexcept : handle{std::exchange(other.handle, {})} {}
+        auto operator=(AsyncTask&& other) noexcept -> AsyncTask& {
+            if(this != &other) {
+                if(handle) { handle.destroy(); }
+                handle = std::exchange(other.handle, {});
+            }
+            return *this;
+        }
+        AsyncTask(const AsyncTask&) = delete;
+        auto operator=(const AsyncTask&) -> AsyncTask& = delete;
+        ~AsyncTask() { if(handle) { handle.destroy(); } }
+
+        auto release() -> Handle { return std::exchange(handle, {}); }
+
+        struct Awaiter {
+            Handle handle = {};
+
+            auto await_ready() const noexcept -> bool { return false; }
+
+            auto await_suspend(std::coroutine_handle<> awaiting) noexcept -> std::coroutine_handle<> {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+
+            auto await_resume() -> T {
+                if(handle.promise().exception) { std::rethrow_exception(handle.promise().exception); }
+                if constexpr (!std::is_void_v<T>) { return std::move(*handle.promise().value); }
+            }
+        };
+
+        auto operator co_await() && noexcept -> Awaiter { return Awaiter { .handle = handle }; }
+
+        Handle handle = {};
+    };
+
+    template<typename T>
+    auto AsyncPromise<T>::get_return_object() -> AsyncTask<T> {
+        return AsyncTask<T>{std::coroutine_handle<AsyncPromise<T>>::from_promise(*this)};
+    }
+
+    inline auto AsyncPromise<void>::get_return_object() -> AsyncTask<void> {
+        return AsyncTask<void>{std::coroutine_handle<AsyncPromise<void>>::from_promise(*this)};
+    }
+
+    // continues the coroutine on a worker of the given class
+    struct ScheduleOnAwaiter {
+        ThreadPool* thread_pool = {};
+        TaskClass task_class = {};
+        TaskPriority priority = {};
+
+        auto await_ready() const noexcept -> bool { return false; }
+        void await_suspend(std::coroutine_handle<> handle) const {
+            thread_pool->submit([handle]() { handle.resume(); }, priority, task_class);
+        }
+        void await_resume() const noexcept {}
+    };
+
+    inline auto schedule_on(ThreadPool* thread_pool, TaskClass task_class, TaskPriority priority = TaskPriority::LOW) -> ScheduleOnAwaiter {
+        return ScheduleOnAwaiter { .thread_pool = thread_pool, .task_class = task_class, .priority = priority };
+    }
+
+    // starts a coroutine without anyone awaiting it, the frame frees itself when it finishes
+    void spawn(ThreadPool* thread_pool, AsyncTask<> task, TaskPriority priority = TaskPriority::LOW, TaskClass task_class = TaskClass::COMPUTE);
+
+    // the read runs on an io worker, the coroutine continues on a compute worker afterwards
+    auto read_file_async(ThreadPool* thread_pool, std::filesystem::path file_path) -> AsyncTask<std::vector<std::byte>>;
+
+    // coroutines waiting for a gpu timeline value, whoever owns the list polls it once per frame
+    struct TimelineWaitList {
+        struct Entry {
+            daxa::TimelineSemaphore semaphore = {};
+            u64 value = {};
+            std::coroutine_handle<> handle = {};
+            ThreadPool* thread_pool = {};
+        };
+
+        struct Awaiter {
+            TimelineWaitList* wait_list = {};
+            Entry entry = {};
+
+            auto await_ready() const -> bool { return entry.semaphore.value() >= entry.value; }
+            void await_suspend(std::coroutine_handle<> handle);
+            void await_resume() const noexcept {}
+        };
+
+        auto wait(ThreadPool* thread_pool, daxa::TimelineSemaphore semaphore, u64 value) -> Awaiter;
+        // resumes every coroutine whose value got reached on the thread pool
+        void poll();
+
+        std::mutex mutex = {};
+        std::vector<Entry> entries = {};
+    };
+}
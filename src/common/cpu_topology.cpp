@@ -0,0 +1,136 @@
+#include "cpu_topology.hpp"
+
+#include <fstream>
+
+#if defined(__linux__)
+#include <sched.h>
+#endif
+
+namespace foundation {
+    auto CpuTopology::has_smt() const -> bool {
+        return std::ranges::any_of(cpus, [](const LogicalCpu& cpu) { return !cpu.smt_primary; });
+    }
+
+    auto CpuTopology::is_hybrid() const -> bool {
+        if(cpus.empty()) { return false; }
+        auto const [min_cpu, max_cpu] = std::ranges::minmax_element(cpus, {}, &LogicalCpu::capacity);
+        return min_cpu->capacity != max_cpu->capacity;
+    }
+
+#if defined(__linux__)
+    static auto read_sysfs_line(const std::filesystem::path& path) -> std::optional<std::string> {
+        std::ifstream file(path);
+        std::string line = {};
+        if(!file || !std::getline(file, line)) { return std::nullopt; }
+        return line;
+    }
+
+    static auto read_sysfs_u32(const std::filesystem::path& path) -> std::optional<u32> {
+        auto line = read_sysfs_line(path);
+        if(!line.has_value()) { return std::nullopt; }
+        try { return s_cast<u32>(std::stoul(line.value())); } catch(...) { return std::nullopt; }
+    }
+
+    // kernel cpu list format, "0-3,8,10-11"
+    static auto parse_cpu_list(const std::string& list) -> std::vector<u32> {
+        std::vector<u32> cpus = {};
+        usize position = 0;
+        while(position < list.size()) {
+            usize const comma = std::min(list.find(',', position), list.size());
+            std::string const range = list.substr(position, comma - position);
+            position = comma + 1;
+            if(range.empty()) { continue; }
+
+            try {
+                usize const dash = range.find('-');
+                u32 const first = s_cast<u32>(std::stoul(range.substr(0, dash)));
+                u32 const last = dash == std::string::npos ? first : s_cast<u32>(std::stoul(range.substr(dash + 1)));
+                for(u32 cpu = first; cpu <= last; cpu++) { cpus.push_back(cpu); }
+            } catch(...) {}
+        }
+        return cpus;
+    }
+
+    auto query_cpu_topology() -> CpuTopology {
+        PROFILE_SCOPE;
+        std::filesystem::path const cpu_root = "/sys/devices/system/cpu";
+        std::filesystem::path const node_root = "/sys/devices/system/node";
+
+        cpu_set_t allowed = {};
+        CPU_ZERO(&allowed);
+        bool const has_allowed = sched_getaffinity(0, sizeof(allowed), &allowed) == 0;
+
+        auto online = read_sysfs_line(cpu_root / "online");
+        if(!online.has_value()) { return {}; }
+
+        // intel hybrid parts list their performance cores here, arm big.little reports cpu_capacity per cpu instead
+        std::vector<u32> performance_cpus = {};
+        if(auto core_cpus = read_sysfs_line("/sys/devices/cpu_core/cpus")) { performance_cpus = parse_cpu_list(core_cpus.value()); }
+
+        CpuTopology topology = {};
+        std::vector<u32> seen_cores = {};
+        for(u32 cpu_index : parse_cpu_list(online.value())) {
+            if(has_allowed && (cpu_index >= CPU_SETSIZE || !CPU_ISSET(cpu_index, &allowed))) { continue; }
+
+            std::filesystem::path const cpu_path = cpu_root / ("cpu" + std::to_string(cpu_index));
+            u32 const package = read_sysfs_u32(cpu_path / "topology/physical_package_id").value_or(0);
+            u32 const core = read_sysfs_u32(cpu_path / "topology/core_id").value_or(cpu_index);
+
+            LogicalCpu cpu = {
+                .cpu_index = cpu_index,
+                .core_index = (package << 16) | (core & 0xffff),
+                .numa_node = 0,
+                .capacity = read_sysfs_u32(cpu_path / "cpu_capacity").value_or(1024),
+                .smt_primary = true,
+            };
+
+            if(!performance_cpus.empty()) {
+                cpu.capacity = std::ranges::find(performance_cpus, cpu_index) != performance_cpus.end() ? 1024u : 512u;
+            }
+
+            // cpus are visited in ascending order so the first allowed sibling of a core becomes its primary
+            cpu.smt_primary = std::ranges::find(seen_cores, cpu.core_index) == seen_cores.end();
+            if(cpu.smt_primary) { seen_cores.push_back(cpu.core_index); }
+
+            topology.cpus.push_back(cpu);
+        }
+
+        std::error_code error = {};
+        for(const auto& entry : std::filesystem::directory_iterator(node_root, error)) {
+            std::string const name = entry.path().filename().string();
+            if(!name.starts_with("node") || name.size() == 4 || !std::isdigit(s_cast<unsigned char>(name[4]))) { continue; }
+
+            u32 const node = s_cast<u32>(std::stoul(name.substr(4)));
+            topology.numa_node_count = std::max(topology.numa_node_count, node + 1);
+            auto node_cpus = read_sysfs_line(entry.path() / "cpulist");
+            if(!node_cpus.has_value()) { continue; }
+
+            for(u32 cpu_index : parse_cpu_list(node_cpus.value())) {
+                auto cpu = std::ranges::find(topology.cpus, cpu_index, &LogicalCpu::cpu_index);
+                if(cpu != topology.cpus.end()) { cpu->numa_node = node; }
+            }
+        }
+
+        return topology;
+    }
+
+    auto set_current_thread_affinity(std::span<const u32> cpu_indices) -> bool {
+        if(cpu_indices.empty()) { return false; }
+
+        cpu_set_t set = {};
+        CPU_ZERO(&set);
+        for(u32 cpu_index : cpu_indices) {
+            if(cpu_index < CPU_SETSIZE) { CPU_SET(cpu_index, &set); }
+        }
+        return sched_setaffinity(0, sizeof(set), &set) == 0;
+    }
+#else
+    auto query_cpu_topology() -> CpuTopology {
+        return {};
+    }
+
+    auto set_current_thread_affinity(std::span<const u32> /*cpu_indices*/) -> bool {
+        return false;
+    }
+#endif
+}
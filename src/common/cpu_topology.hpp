@@ -0,0 +1,29 @@
+#pragma once
+
+namespace foundation {
+    struct LogicalCpu {
+        u32 cpu_index = {};
+        // unique across packages, smt siblings share it
+        u32 core_index = {};
+        u32 numa_node = {};
+        // relative performance, efficiency cores of hybrid parts report less than performance cores
+        u32 capacity = {};
+        // first hardware thread of its core, the other siblings are false
+        bool smt_primary = true;
+    };
+
+    struct CpuTopology {
+        // only cpus the process is allowed to run on, sorted by cpu_index
+        std::vector<LogicalCpu> cpus = {};
+        u32 numa_node_count = 1;
+
+        auto has_smt() const -> bool;
+        auto is_hybrid() const -> bool;
+    };
+
+    // reads /sys/devices/system on linux, empty on other platforms
+    auto query_cpu_topology() -> CpuTopology;
+
+    // restricts the calling thread to the given cpus, returns false when the os refused or doesnt support it
+    auto set_current_thread_affinity(std::span<const u32> cpu_indices) -> bool;
+}
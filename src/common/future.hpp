@@ -0,0 +1,129 @@
+#pragma once
+#include <variant>
+#include "common/thread_pool.hpp"
+
+namespace foundation {
+    template<typename T>
+    using FutureValue = std::conditional_t<std::is_void_v<T>, std::monostate, T>;
+
+    // the result lives inside the task, it is published by the task finishing so reading it needs no lock
+    template<typename T>
+    struct FutureTask : Task {
+        std::optional<FutureValue<T>> result = {};
+    };
+
+    template<typename T, typename Fn>
+    struct CallableFutureTask : FutureTask<T> {
+        Fn fn;
+        explicit CallableFutureTask(Fn _fn) : fn{std::move(_fn)} { this->chunk_count = 1; }
+
+        virtual void callback(u32 /*chunk_index*/, u32 /*thread_index*/) override {
+            if constexpr (std::is_void_v<T>) { fn(); this->result.emplace(); }
+            else { this->result.emplace(fn()); }
+        }
+    };
+
+    template<typename T, typename U, typename Fn>
+    struct ContinuationFutureTask : FutureTask<T> {
+        std::shared_ptr<FutureTask<U>> predecessor = {};
+        Fn fn;
+        ContinuationFutureTask(std::shared_ptr<FutureTask<U>> _predecessor, Fn _fn) : predecessor{std::move(_predecessor)}, fn{std::move(_fn)} { this->chunk_count = 1; }
+
+        virtual void callback(u32 /*chunk_index*/, u32 /*thread_index*/) override {
+            // a cancelled predecessor leaves no result behind, the continuation stays empty as well
+            if(predecessor->result.has_value()) {
+                auto invoke = [&]() -> decltype(auto) {
+                    if constexpr (std::is_void_v<U>) { return fn(); }
+                    else { return fn(std::move(*predecessor->result)); }
+                };
+
+                if constexpr (std::is_void_v<T>) { invoke(); this->result.emplace(); }
+                else { this->result.emplace(invoke()); }
+            }
+            predecessor = {};
+        }
+    };
+
+    template<typename U, typename Fn>
+    struct ContinuationResult { using type = std::invoke_result_t<Fn&, U&&>; };
+
+    template<typename Fn>
+    struct ContinuationResult<void, Fn> { using type = std::invoke_result_t<Fn&>; };
+
+    template<typename T>
+    struct WhenAllFutureTask : FutureTask<std::vector<FutureValue<T>>> {
+        std::vector<std::shared_ptr<FutureTask<T>>> predecessors = {};
+        explicit WhenAllFutureTask(std::vector<std::shared_ptr<FutureTask<T>>> _predecessors) : predecessors{std::move(_predecessors)} { this->chunk_count = 1; }
+
+        virtual void callback(u32 /*chunk_index*/, u32 /*thread_index*/) override {
+            std::vector<FutureValue<T>> values = {};
+            values.reserve(predecessors.size());
+            for(auto& predecessor : predecessors) {
+                if(!predecessor->result.has_value()) { predecessors = {}; return; }
+                values.push_back(std::move(*predecessor->result));
+            }
+            this->result.emplace(std::move(values));
+            predecessors = {};
+        }
+    };
+
+    template<typename T>
+    struct Future {
+        ThreadPool* thread_pool = {};
+        std::shared_ptr<FutureTask<T>> task = {};
+
+        auto valid() const -> bool { return task != nullptr; }
+        auto is_ready() const -> bool { return task && task->not_finished.load(std::memory_order_acquire) == 0; }
+
+        // moves the result out once the task finished, empty while it is still running or after it got taken
+        auto try_get() -> std::optional<FutureValue<T>> {
+            if(!is_ready() || !task->result.has_value()) { return std::nullopt; }
+            return std::exchange(task->result, std::nullopt);
+        }
+
+        // the calling thread helps out with other work while waiting
+        auto get() -> std::optional<FutureValue<T>> {
+            thread_pool->block_on(task);
+            return std::exchange(task->result, std::nullopt);
+        }
+
+        // fn receives the result by value, the result is consumed by the continuation
+        template<typename Fn>
+        auto then(Fn&& fn, TaskPriority priority = TaskPriority::LOW, TaskClass task_class = TaskClass::COMPUTE) {
+            using Callable = std::decay_t<Fn>;
+            using Result = typename ContinuationResult<T, Callable>::type;
+
+            auto next = std::make_shared<ContinuationFutureTask<Result, T, Callable>>(task, std::forward<Fn>(fn));
+            std::array<std::shared_ptr<Task>, 1> predecessors = { task };
+            thread_pool->async_dispatch_after(next, predecessors, priority, task_class);
+            return Future<Result> { .thread_pool = thread_pool, .task = std::move(next) };
+        }
+    };
+
+    template<typename Fn>
+    auto ThreadPool::submit_future(Fn&& fn, TaskPriority priority, TaskClass task_class) -> Future<std::invoke_result_t<std::decay_t<Fn>&>> {
+        using Callable = std::decay_t<Fn>;
+        using Result = std::invoke_result_t<Callable&>;
+
+        auto task = std::make_shared<CallableFutureTask<Result, Callable>>(std::forward<Fn>(fn));
+        async_dispatch(task, priority, task_class);
+        return Future<Result> { .thread_pool = this, .task = std::move(task) };
+    }
+
+    // resolves once every future finished, empty if any of them got cancelled
+    template<typename T>
+    auto when_all(ThreadPool* thread_pool, std::span<Future<T>> futures, TaskPriority priority = TaskPriority::LOW) -> Future<std::vector<FutureValue<T>>> {
+        std::vector<std::shared_ptr<FutureTask<T>>> predecessor_tasks = {};
+        std::vector<std::shared_ptr<Task>> predecessors = {};
+        predecessor_tasks.reserve(futures.size());
+        predecessors.reserve(futures.size());
+        for(const Future<T>& future : futures) {
+            predecessor_tasks.push_back(future.task);
+            predecessors.push_back(future.task);
+        }
+
+        auto task = std::make_shared<WhenAllFutureTask<T>>(std::move(predecessor_tasks));
+        thread_pool->async_dispatch_after(task, predecessors, priority);
+        return Future<std::vector<FutureValue<T>>> { .thread_pool = thread_pool, .task = std::move(task) };
+    }
+}
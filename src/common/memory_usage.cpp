@@ -0,0 +1,34 @@
+#include "memory_usage.hpp"
+
+#include <fstream>
+
+namespace foundation {
+#if defined(__linux__)
+    auto query_peak_resident_bytes() -> std::optional<u64> {
+        std::ifstream file("/proc/self/status");
+        std::string line = {};
+        while(std::getline(file, line)) {
+            if(!line.starts_with("VmHWM:")) { continue; }
+            // reported in kB
+            try { return s_cast<u64>(std::stoull(line.substr(6))) * 1024; } catch(...) { return std::nullopt; }
+        }
+        return std::nullopt;
+    }
+
+    auto reset_peak_resident_bytes() -> bool {
+        // "5" only resets VmHWM, the other clear_refs values touch page table bits
+        std::ofstream file("/proc/self/clear_refs");
+        if(!file) { return false; }
+        file << "5";
+        return s_cast<bool>(file.flush());
+    }
+#else
+    auto query_peak_resident_bytes() -> std::optional<u64> {
+        return std::nullopt;
+    }
+
+    auto reset_peak_resident_bytes() -> bool {
+        return false;
+    }
+#endif
+}
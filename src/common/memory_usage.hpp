@@ -0,0 +1,9 @@
+#pragma once
+
+namespace foundation {
+    // high water mark of the resident set since process start or the last reset, nullopt where the os doesnt report it
+    auto query_peak_resident_bytes() -> std::optional<u64>;
+
+    // starts a new high water mark from the current resident set, returns false when the os doesnt support it
+    auto reset_peak_resident_bytes() -> bool;
+}
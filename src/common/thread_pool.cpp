@@ -1,102 +1,708 @@
 #include "thread_pool.hpp"
+#include "cpu_topology.hpp"
+
+#include <latch>
 
 namespace foundation {
+    static constexpr i64 WORK_STEALING_DEQUE_CAPACITY = 4096;
+    static constexpr usize MAX_INJECTOR_BATCH_SIZE = 32;
+    static constexpr usize PRIORITY_COUNT = 2;
+
+    // Chase-Lev deque, only the owning worker pushes and pops at the bottom, other workers steal from the top
+    struct WorkStealingDeque {
+        alignas(64) std::atomic<i64> top = {};
+        alignas(64) std::atomic<i64> bottom = {};
+        alignas(64) std::array<std::atomic<Task*>, WORK_STEALING_DEQUE_CAPACITY> buffer = {};
+
+        auto push(Task* task) -> bool {
+            i64 const b = bottom.load(std::memory_order_relaxed);
+            i64 const t = top.load(std::memory_order_acquire);
+            if(b - t >= WORK_STEALING_DEQUE_CAPACITY) { return false; }
+
+            buffer[s_cast<usize>(b & (WORK_STEALING_DEQUE_CAPACITY - 1))].store(task, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return true;
+        }
+
+        auto pop() -> Task* {
+            i64 const b = bottom.load(std::memory_order_relaxed) - 1;
+            bottom.store(b, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            i64 t = top.load(std::memory_order_relaxed);
+
+            if(t > b) {
+                bottom.store(b + 1, std::memory_order_relaxed);
+                return nullptr;
+            }
+
+            Task* task = buffer[s_cast<usize>(b & (WORK_STEALING_DEQUE_CAPACITY - 1))].load(std::memory_order_relaxed);
+            if(t == b) {
+                // last entry, race against thieves
+                if(!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) { task = nullptr; }
+                bottom.store(b + 1, std::memory_order_relaxed);
+            }
+
+            return task;
+        }
+
+        auto steal() -> Task* {
+            while(true) {
+                i64 t = top.load(std::memory_order_acquire);
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                i64 const b = bottom.load(std::memory_order_acquire);
+                if(t >= b) { return nullptr; }
+
+                Task* task = buffer[s_cast<usize>(t & (WORK_STEALING_DEQUE_CAPACITY - 1))].load(std::memory_order_relaxed);
+                if(top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) { return task; }
+            }
+        }
+    };
+
+    static constexpr std::array<const char*, TASK_CLASS_COUNT> BUSY_WORKERS_PLOT_NAMES = { "compute workers busy", "io workers busy", "latency critical workers busy" };
+    [[maybe_unused]] static constexpr std::array<const char*, TASK_CLASS_COUNT> QUEUED_ENTRIES_PLOT_NAMES = { "compute queued entries", "io queued entries", "latency critical queued entries" };
+
+    static constexpr std::array<const char*, TASK_CLASS_COUNT> TASK_CLASS_NAMES = { "compute", "io", "latency critical" };
+
+    // only written by the owning worker, other threads just sample them
+    struct WorkerCounters {
+        std::atomic<u64> executed_entries = {};
+        std::atomic<u64> steals = {};
+        std::atomic<u64> failed_steal_rounds = {};
+        std::atomic<u64> busy_ns = {};
+        std::atomic<u64> idle_ns = {};
+        std::atomic<u64> injector_lock_wait_ns = {};
+    };
+
+    struct WorkerData {
+        std::array<WorkStealingDeque, PRIORITY_COUNT> queues = {};
+        u64 random_state = {};
+        TaskClass task_class = {};
+        WorkerCounters counters = {};
+    };
+
+    static auto now_ns() -> u64 {
+        return s_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    static void add_counter(std::atomic<u64>& counter, u64 value) {
+        counter.store(counter.load(std::memory_order_relaxed) + value, std::memory_order_relaxed);
+    }
+
+    // workers of one task class, they only take and steal work dispatched to their own class
+    struct WorkerGroup {
+        u32 first_worker = {};
+        u32 worker_count = {};
+
+        // tasks dispatched from threads outside of the group land here, workers pull them in batches
+        std::mutex injector_mutex = {};
+        std::array<std::deque<Task*>, PRIORITY_COUNT> injector = {};
+        std::array<std::atomic<u32>, PRIORITY_COUNT> injector_size = {};
+
+        // idle workers park on this futex, every submission bumps it
+        std::atomic<u32> work_generation = {};
+        std::atomic<u32> sleeping_workers = {};
+
+        std::atomic<u32> queued_entries = {};
+        std::atomic<u32> busy_workers = {};
+        u32 max_queued_entries = {};
+    };
+
+    struct ThreadPool::SharedData {
+        std::vector<std::unique_ptr<WorkerData>> workers = {};
+        std::array<WorkerGroup, TASK_CLASS_COUNT> groups = {};
+        std::atomic<u64> dropped_chunks = {};
+        std::atomic<bool> kill = false;
+        // workers only look at each other once every one of them allocated its data
+        std::unique_ptr<std::latch> startup_latch = {};
+    };
+
+    struct TaskContinuation {
+        std::shared_ptr<Task> task = {};
+        ThreadPool::SharedData* shared_data = {};
+        TaskPriority priority = {};
+        TaskClass task_class = {};
+        TaskContinuation* next = {};
+    };
+
+    // continuation list head of a finished task, registering behind it schedules the successor right away
+    static TaskContinuation closed_continuations = {};
+
+    Task::~Task() {
+        TaskContinuation* continuation = continuations.load(std::memory_order_acquire);
+        if(continuation == &closed_continuations) { return; }
+
+        while(continuation != nullptr) {
+            TaskContinuation* next = continuation->next;
+            delete continuation;
+            continuation = next;
+        }
+    }
+
+    void Task::on_released() {
+        std::shared_ptr<Task> self = std::move(keep_alive);
+    }
+
+    struct InlineTaskFreeList {
+        InlineTask* local = {};
+        // tasks finished on other threads are pushed here and taken over in one go once the local list runs dry
+        std::atomic<InlineTask*> remote = {};
+    };
+
+    // never freed, tasks acquired on a thread can still be in flight after it exited
+    static thread_local InlineTaskFreeList* current_free_list = nullptr;
+
+    static auto get_current_free_list() -> InlineTaskFreeList* {
+        if(current_free_list == nullptr) { current_free_list = new InlineTaskFreeList(); }
+        return current_free_list;
+    }
+
+    auto acquire_inline_task() -> InlineTask* {
+        InlineTaskFreeList* free_list = get_current_free_list();
+        if(free_list->local == nullptr) {
+            free_list->local = free_list->remote.exchange(nullptr, std::memory_order_acquire);
+        }
+
+        if(free_list->local == nullptr) {
+            auto* task = new InlineTask();
+            task->owner = free_list;
+            task->chunk_count = 1;
+            return task;
+        }
+
+        InlineTask* task = free_list->local;
+        free_list->local = task->next_free;
+        task->next_free = nullptr;
+        return task;
+    }
+
+    void InlineTask::callback(u32 /*chunk_index*/, u32 /*thread_index*/) {
+        invoke(payload.data());
+    }
+
+    void InlineTask::on_released() {
+        destroy(payload.data());
+        invoke = nullptr;
+        destroy = nullptr;
+        cancellation = {};
+
+        if(owner == current_free_list) {
+            next_free = owner->local;
+            owner->local = this;
+            return;
+        }
+
+        InlineTask* head = owner->remote.load(std::memory_order_relaxed);
+        do {
+            next_free = head;
+        } while(!owner->remote.compare_exchange_weak(head, this, std::memory_order_release, std::memory_order_relaxed));
+    }
+
+    static thread_local ThreadPool::SharedData* current_pool = nullptr;
+    static thread_local u32 current_worker_index = EXTERNAL_THREAD_INDEX;
+
+    static auto priority_index(TaskPriority priority) -> usize {
+        return priority == TaskPriority::HIGH ? 0 : 1;
+    }
+
+    static auto group_of(ThreadPool::SharedData& shared_data, TaskClass task_class) -> WorkerGroup& {
+        return shared_data.groups[s_cast<usize>(task_class)];
+    }
+
+    // classes configured without workers are served by the compute workers
+    static auto resolve_task_class(const ThreadPool::SharedData& shared_data, TaskClass task_class) -> TaskClass {
+        return shared_data.groups[s_cast<usize>(task_class)].worker_count == 0 ? TaskClass::COMPUTE : task_class;
+    }
+
+    static auto next_random(u64& state) -> u64 {
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        return state;
+    }
+
+    static auto current_thread_index(ThreadPool::SharedData& shared_data) -> u32 {
+        return current_pool == &shared_data ? current_worker_index : EXTERNAL_THREAD_INDEX;
+    }
+
+    static void wake_workers(WorkerGroup& group, u32 entry_count) {
+        group.work_generation.fetch_add(1, std::memory_order_seq_cst);
+        if(group.sleeping_workers.load(std::memory_order_seq_cst) == 0) { return; }
+
+        if(entry_count > 1) { group.work_generation.notify_all(); }
+        else { group.work_generation.notify_one(); }
+    }
+
+    static void push_to_injector(WorkerGroup& group, Task* task, u32 entry_count, TaskPriority priority) {
+        usize const queue_index = priority_index(priority);
+        std::lock_guard lock{group.injector_mutex};
+        auto& queue = group.injector[queue_index];
+        for(u32 entry_index = 0; entry_index < entry_count; entry_index++) {
+            queue.push_back(task);
+        }
+        group.injector_size[queue_index].store(s_cast<u32>(queue.size()), std::memory_order_release);
+    }
+
+    static void schedule(ThreadPool::SharedData& shared_data, Task* task, u32 entry_count, TaskPriority priority) {
+        if(entry_count == 0) { return; }
+
+        WorkerGroup& group = group_of(shared_data, task->task_class);
+        [[maybe_unused]] u32 const queued_entries = group.queued_entries.fetch_add(entry_count, std::memory_order_relaxed) + entry_count;
+        PROFILE_PLOT(QUEUED_ENTRIES_PLOT_NAMES[s_cast<usize>(task->task_class)], s_cast<i64>(queued_entries));
+
+        u32 const thread_index = current_thread_index(shared_data);
+        u32 pushed_count = 0;
+        if(thread_index != EXTERNAL_THREAD_INDEX && shared_data.workers[thread_index]->task_class == task->task_class) {
+            auto& queue = shared_data.workers[thread_index]->queues[priority_index(priority)];
+            while(pushed_count < entry_count && queue.push(task)) { pushed_count++; }
+        }
+
+        if(pushed_count < entry_count) {
+            push_to_injector(group, task, entry_count - pushed_count, priority);
+        }
+
+        wake_workers(group, entry_count);
+    }
+
+    static auto take_from_injector(ThreadPool::SharedData& shared_data, u32 thread_index, usize queue_index) -> Task* {
+        WorkerGroup& group = group_of(shared_data, shared_data.workers[thread_index]->task_class);
+        if(group.injector_size[queue_index].load(std::memory_order_acquire) == 0) { return nullptr; }
+
+        u64 const lock_start = now_ns();
+        std::lock_guard lock{group.injector_mutex};
+        add_counter(shared_data.workers[thread_index]->counters.injector_lock_wait_ns, now_ns() - lock_start);
+        auto& queue = group.injector[queue_index];
+        if(queue.empty()) { return nullptr; }
+
+        Task* task = queue.front();
+        queue.pop_front();
+
+        // grab a fair share of the remaining entries so the next ones dont have to go through the lock
+        usize const batch_size = std::min(queue.size() / group.worker_count, MAX_INJECTOR_BATCH_SIZE);
+        auto& local_queue = shared_data.workers[thread_index]->queues[queue_index];
+        for(usize batch_index = 0; batch_index < batch_size; batch_index++) {
+            if(!local_queue.push(queue.front())) { break; }
+            queue.pop_front();
+        }
+
+        group.injector_size[queue_index].store(s_cast<u32>(queue.size()), std::memory_order_release);
+        return task;
+    }
+
+    static auto steal_work(ThreadPool::SharedData& shared_data, u32 thread_index, usize queue_index) -> Task* {
+        const WorkerGroup& group = group_of(shared_data, shared_data.workers[thread_index]->task_class);
+        if(group.worker_count < 2) { return nullptr; }
+
+        u32 const start = s_cast<u32>(next_random(shared_data.workers[thread_index]->random_state) % group.worker_count);
+        for(u32 offset = 0; offset < group.worker_count; offset++) {
+            u32 const victim = group.first_worker + (start + offset) % group.worker_count;
+            if(victim == thread_index) { continue; }
+
+            if(Task* task = shared_data.workers[victim]->queues[queue_index].steal()) {
+                add_counter(shared_data.workers[thread_index]->counters.steals, 1);
+                return task;
+            }
+        }
+
+        add_counter(shared_data.workers[thread_index]->counters.failed_steal_rounds, 1);
+        return nullptr;
+    }
+
+    static auto find_work(ThreadPool::SharedData& shared_data, u32 thread_index) -> Task* {
+        for(usize queue_index = 0; queue_index < PRIORITY_COUNT; queue_index++) {
+            if(Task* task = shared_data.workers[thread_index]->queues[queue_index].pop()) { return task; }
+            if(Task* task = take_from_injector(shared_data, thread_index, queue_index)) { return task; }
+            if(Task* task = steal_work(shared_data, thread_index, queue_index)) { return task; }
+        }
+
+        return nullptr;
+    }
+
+    static void start_task(ThreadPool::SharedData& shared_data, std::shared_ptr<Task> task, TaskPriority priority, TaskClass task_class);
+
+    static void complete_task(Task* task) {
+        TaskContinuation* continuation = task->continuations.exchange(&closed_continuations, std::memory_order_acq_rel);
+        while(continuation != nullptr) {
+            TaskContinuation* next = continuation->next;
+            if(continuation->task->unfinished_dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                start_task(*continuation->shared_data, std::move(continuation->task), continuation->priority, continuation->task_class);
+            }
+
+            delete continuation;
+            continuation = next;
+        }
+    }
+
+    static void finish_chunk(Task* task) {
+        if(task->not_finished.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            complete_task(task);
+            task->not_finished.notify_all();
+        }
+    }
+
+    static void reset_task(Task* task) {
+        // a finished task can be dispatched again, continuations registered before that are kept
+        TaskContinuation* closed = &closed_continuations;
+        task->continuations.compare_exchange_strong(closed, nullptr, std::memory_order_acq_rel);
+        task->started.store(0, std::memory_order_relaxed);
+        task->not_finished.store(task->chunk_count, std::memory_order_relaxed);
+    }
+
+    static void enqueue_task(ThreadPool::SharedData& shared_data, Task* task, TaskPriority priority) {
+        task->references.store(task->chunk_count, std::memory_order_relaxed);
+        schedule(shared_data, task, task->chunk_count, priority);
+    }
+
+    static void start_task(ThreadPool::SharedData& shared_data, std::shared_ptr<Task> task, TaskPriority priority, TaskClass task_class) {
+        task->task_class = resolve_task_class(shared_data, task_class);
+        reset_task(task.get());
+        if(task->chunk_count == 0) {
+            complete_task(task.get());
+            task->not_finished.notify_all();
+            return;
+        }
+
+        Task* task_ptr = task.get();
+        task_ptr->keep_alive = std::move(task);
+        enqueue_task(shared_data, task_ptr, priority);
+    }
+
+    static void run_chunks(ThreadPool::SharedData& shared_data, Task* task, u32 thread_index, bool run_all) {
+        do {
+            u32 const chunk_index = task->started.fetch_add(1, std::memory_order_acq_rel);
+            if(chunk_index >= task->chunk_count) { return; }
+
+            // dropped chunks still count as finished so waiters and successors dont hang
+            if(task->cancellation.is_cancelled()) {
+                shared_data.dropped_chunks.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                task->callback(chunk_index, thread_index);
+            }
+            finish_chunk(task);
+        } while(run_all);
+    }
+
+    static void run_entry(ThreadPool::SharedData& shared_data, Task* task, u32 thread_index) {
+        WorkerGroup& group = group_of(shared_data, task->task_class);
+        [[maybe_unused]] u32 const queued_entries = group.queued_entries.fetch_sub(1, std::memory_order_relaxed) - 1;
+        PROFILE_PLOT(QUEUED_ENTRIES_PLOT_NAMES[s_cast<usize>(task->task_class)], s_cast<i64>(queued_entries));
+
+        // an entry is a ticket for one chunk, the chunk itself might already be taken by a blocking dispatch
+        run_chunks(shared_data, task, thread_index, false);
+
+        if(task->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            task->on_released();
+        }
+    }
+
+    static void wait_until_finished(ThreadPool::SharedData& shared_data, Task* task) {
+        u32 const thread_index = current_thread_index(shared_data);
+        u32 remaining = task->not_finished.load(std::memory_order_acquire);
+        while(remaining != 0) {
+            // workers help out instead of parking so nested dispatches cant starve the pool
+            if(thread_index != EXTERNAL_THREAD_INDEX) {
+                if(Task* other_task = find_work(shared_data, thread_index)) {
+                    run_entry(shared_data, other_task, thread_index);
+                    remaining = task->not_finished.load(std::memory_order_acquire);
+                    continue;
+                }
+            }
+
+            task->not_finished.wait(remaining, std::memory_order_acquire);
+            remaining = task->not_finished.load(std::memory_order_acquire);
+        }
+    }
+
     ThreadPool::~ThreadPool() {
-        {
-            std::unique_lock lock{shared_data->threadpool_mutex};
-            shared_data->kill = true;
-            shared_data->work_available.notify_all();
+        if(!shared_data) { return; }
+
+        shared_data->kill.store(true, std::memory_order_seq_cst);
+        for(auto& group : shared_data->groups) {
+            group.work_generation.fetch_add(1, std::memory_order_seq_cst);
+            group.work_generation.notify_all();
         }
 
         for (auto & worker : worker_threads) {
             worker.join();
         }
+
+        // release whatever was still queued so the tasks dont leak
+        auto release = [](Task* task) {
+            if(task->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                task->on_released();
+            }
+        };
+
+        for(auto& worker_data : shared_data->workers) {
+            for(auto& queue : worker_data->queues) {
+                while(Task* task = queue.steal()) { release(task); }
+            }
+        }
+
+        for(auto& group : shared_data->groups) {
+            for(auto& queue : group.injector) {
+                for(Task* task : queue) { release(task); }
+                queue.clear();
+            }
+        }
     }
 
     void ThreadPool::worker(std::shared_ptr<ThreadPool::SharedData> shared_data, u32 thread_index) {
-        std::unique_lock lock{shared_data->threadpool_mutex};
+        current_pool = shared_data.get();
+        current_worker_index = thread_index;
+
+        TaskClass const task_class = shared_data->workers[thread_index]->task_class;
+        WorkerGroup& group = group_of(*shared_data, task_class);
+        WorkerCounters& counters = shared_data->workers[thread_index]->counters;
+        [[maybe_unused]] const char* busy_plot_name = BUSY_WORKERS_PLOT_NAMES[s_cast<usize>(task_class)];
+
+        [[maybe_unused]] const std::string thread_name = fmt::format("{} worker {}", TASK_CLASS_NAMES[s_cast<usize>(task_class)], thread_index - group.first_worker);
+        PROFILE_THREAD_NAME(thread_name.c_str());
+
         while (true) {
-            shared_data->work_available.wait(lock, [&] { return !shared_data->high_priority_tasks.empty() || !shared_data->low_priority_tasks.empty() || shared_data->kill; });
-            
-            if (shared_data->kill) { return; }
+            u32 const generation = group.work_generation.load(std::memory_order_seq_cst);
+            if (shared_data->kill.load(std::memory_order_seq_cst)) { return; }
 
-            bool const high_priority_work_available = !shared_data->high_priority_tasks.empty();
-            auto & selected_queue = high_priority_work_available ? shared_data->high_priority_tasks : shared_data->low_priority_tasks;
-            TaskChunk current_chunk = std::move(selected_queue.front());
-            selected_queue.pop_front();
-            current_chunk.task->started += 1;
-            lock.unlock();
+            if(Task* task = find_work(*shared_data, thread_index)) {
+                PROFILE_PLOT(busy_plot_name, s_cast<i64>(group.busy_workers.fetch_add(1, std::memory_order_relaxed) + 1));
+                u64 const busy_start = now_ns();
+                run_entry(*shared_data, task, thread_index);
+                add_counter(counters.busy_ns, now_ns() - busy_start);
+                add_counter(counters.executed_entries, 1);
+                PROFILE_PLOT(busy_plot_name, s_cast<i64>(group.busy_workers.fetch_sub(1, std::memory_order_relaxed) - 1));
+                continue;
+            }
+
+            u64 const idle_start = now_ns();
+            group.sleeping_workers.fetch_add(1, std::memory_order_seq_cst);
+            group.work_generation.wait(generation, std::memory_order_seq_cst);
+            group.sleeping_workers.fetch_sub(1, std::memory_order_seq_cst);
+            add_counter(counters.idle_ns, now_ns() - idle_start);
+        }
+    }
 
-            current_chunk.task->callback(current_chunk.chunk_index, thread_index);
+    // cpus a class may use, primaries come before their smt siblings so pinning fills physical cores first
+    static auto placement_cpus(const CpuTopology& topology, const ThreadPlacementInfo& placement, bool skip_smt_siblings, bool performance_only) -> std::vector<u32> {
+        std::vector<LogicalCpu> cpus = {};
+        for(const LogicalCpu& cpu : topology.cpus) {
+            if(!placement.cpuset.empty() && std::ranges::find(placement.cpuset, cpu.cpu_index) == placement.cpuset.end()) { continue; }
+            if(skip_smt_siblings && !cpu.smt_primary) { continue; }
+            cpus.push_back(cpu);
+        }
 
-            lock.lock();
-            current_chunk.task->not_finished -= 1;
-            if (current_chunk.task->not_finished == 0) { shared_data->work_done.notify_all(); }
+        if(performance_only && !cpus.empty()) {
+            u32 const max_capacity = std::ranges::max(cpus, {}, &LogicalCpu::capacity).capacity;
+            std::erase_if(cpus, [&](const LogicalCpu& cpu) { return cpu.capacity != max_capacity; });
         }
+
+        std::ranges::stable_sort(cpus, std::ranges::greater{}, &LogicalCpu::smt_primary);
+
+        std::vector<u32> cpu_indices = {};
+        cpu_indices.reserve(cpus.size());
+        for(const LogicalCpu& cpu : cpus) { cpu_indices.push_back(cpu.cpu_index); }
+        return cpu_indices;
     }
 
-    ThreadPool::ThreadPool(std::optional<u32> thread_count) {
-        u32 const real_thread_count = thread_count.value_or(std::thread::hardware_concurrency());
+    ThreadPool::ThreadPool(const ThreadPoolInfo& info) {
+        const ThreadPlacementInfo& placement = info.placement;
+        CpuTopology const topology = query_cpu_topology();
+        bool const performance_only = placement.prefer_performance_cores && topology.is_hybrid();
+
+        // io workers mostly sleep in syscalls, they only honor the cpuset
+        std::array<std::vector<u32>, TASK_CLASS_COUNT> const class_cpus = {
+            placement_cpus(topology, placement, placement.avoid_smt_siblings, performance_only),
+            placement_cpus(topology, placement, false, false),
+            placement_cpus(topology, placement, false, performance_only),
+        };
+
+        u32 default_compute_thread_count = std::thread::hardware_concurrency();
+        if(placement.avoid_smt_siblings && !class_cpus[0].empty()) { default_compute_thread_count = s_cast<u32>(class_cpus[0].size()); }
+
+        std::array<u32, TASK_CLASS_COUNT> const thread_counts = {
+            std::max(info.compute_thread_count.value_or(default_compute_thread_count), 1u),
+            info.io_thread_count,
+            info.latency_critical_thread_count,
+        };
+
+        bool const restricts_cpus = !placement.cpuset.empty() || placement.avoid_smt_siblings || performance_only;
+
+        struct WorkerStartInfo {
+            TaskClass task_class = {};
+            std::vector<u32> cpus = {};
+        };
+        std::vector<WorkerStartInfo> start_infos = {};
+
         shared_data = std::make_shared<SharedData>();
+        for(usize class_index = 0; class_index < TASK_CLASS_COUNT; class_index++) {
+            WorkerGroup& group = shared_data->groups[class_index];
+            group.first_worker = s_cast<u32>(start_infos.size());
+            group.worker_count = thread_counts[class_index];
+            group.max_queued_entries = info.max_queued_entries[class_index];
+
+            const std::vector<u32>& cpus = class_cpus[class_index];
+            for(u32 group_thread_index = 0; group_thread_index < group.worker_count; group_thread_index++) {
+                WorkerStartInfo start_info = { .task_class = s_cast<TaskClass>(class_index) };
+                if(s_cast<TaskClass>(class_index) == TaskClass::COMPUTE && placement.pin_workers && !cpus.empty()) {
+                    start_info.cpus = { cpus[group_thread_index % cpus.size()] };
+                } else if(restricts_cpus) {
+                    start_info.cpus = cpus;
+                }
+                start_infos.push_back(std::move(start_info));
+            }
+        }
+
+        u32 const real_thread_count = s_cast<u32>(start_infos.size());
+        shared_data->workers.resize(real_thread_count);
+        shared_data->startup_latch = std::make_unique<std::latch>(real_thread_count);
         for (u32 thread_index = 0; thread_index < real_thread_count; thread_index++) {
             worker_threads.push_back({
-                std::thread([=, this]() { ThreadPool::worker(shared_data, thread_index); }),
+                // the pool may be moved once the constructor returns, workers only ever see their own copy of shared_data
+                std::thread([shared_data = shared_data, thread_index, start_info = std::move(start_infos[thread_index])]() {
+                    if(!start_info.cpus.empty()) { set_current_thread_affinity(start_info.cpus); }
+
+                    // allocated after pinning so first touch puts the deques on the numa node of the worker
+                    auto worker_data = std::make_unique<WorkerData>();
+                    worker_data->random_state = 0x9e3779b97f4a7c15ull * (thread_index + 1);
+                    worker_data->task_class = start_info.task_class;
+                    shared_data->workers[thread_index] = std::move(worker_data);
+                    shared_data->startup_latch->arrive_and_wait();
+
+                    ThreadPool::worker(shared_data, thread_index);
+                }),
             });
         }
+        shared_data->startup_latch->wait();
     }
 
-    void ThreadPool::blocking_dispatch(std::shared_ptr<Task> task, TaskPriority priority) {
-        task->not_finished = task->chunk_count;
-        auto & selected_queue = priority == TaskPriority::HIGH ? shared_data->high_priority_tasks : shared_data->low_priority_tasks;
-
-        std::unique_lock lock{shared_data->threadpool_mutex};
+    void ThreadPool::blocking_dispatch(std::shared_ptr<Task> task, TaskPriority priority, TaskClass task_class) {
+        task->task_class = resolve_task_class(*shared_data, task_class);
+        reset_task(task.get());
+        if(task->chunk_count == 0) {
+            complete_task(task.get());
+            return;
+        }
 
-        for (u32 chunk_index = 1; chunk_index < task->chunk_count; chunk_index++) {
-            selected_queue.push_back({task, chunk_index});
+        u32 const entry_count = task->chunk_count - 1;
+        if(entry_count != 0) {
+            task->references.store(entry_count, std::memory_order_relaxed);
+            task->keep_alive = task;
+            schedule(*shared_data, task.get(), entry_count, priority);
         }
 
-        shared_data->work_available.notify_all();
+        // the calling thread works on the task as well until there are no more chunks to start
+        run_chunks(*shared_data, task.get(), current_thread_index(*shared_data), true);
+        wait_until_finished(*shared_data, task.get());
+    }
 
-        u32 current_chunk_index = 0;
-        bool worked_on_last_chunk = false;
-        while (current_chunk_index != NO_MORE_CHUNKS_CODE) {
-            task->started += 1;
+    void ThreadPool::async_dispatch(std::shared_ptr<Task> task, TaskPriority priority, TaskClass task_class) {
+        start_task(*shared_data, std::move(task), priority, task_class);
+    }
 
-            lock.unlock();
-            task->callback(current_chunk_index, EXTERNAL_THREAD_INDEX);
-            lock.lock();
+    auto ThreadPool::try_async_dispatch(std::shared_ptr<Task> task, TaskPriority priority, TaskClass task_class) -> bool {
+        if(!has_queue_space(task_class, task->chunk_count)) { return false; }
+        start_task(*shared_data, std::move(task), priority, task_class);
+        return true;
+    }
 
-            task->not_finished -= 1;
-            bool more_chunks_in_queue = (task->started != task->chunk_count);
-            if (more_chunks_in_queue) {
-                current_chunk_index = selected_queue.front().chunk_index;
-                selected_queue.pop_front();
+    auto ThreadPool::has_queue_space(TaskClass task_class, u32 entry_count) const -> bool {
+        const WorkerGroup& group = shared_data->groups[s_cast<usize>(resolve_task_class(*shared_data, task_class))];
+        if(group.max_queued_entries == 0) { return true; }
+        return group.queued_entries.load(std::memory_order_relaxed) + entry_count <= group.max_queued_entries;
+    }
+
+    void ThreadPool::async_dispatch_after(std::shared_ptr<Task> task, std::span<const std::shared_ptr<Task>> predecessors, TaskPriority priority, TaskClass task_class) {
+        // the extra dependency keeps the task from starting while predecessors are still being registered
+        task->unfinished_dependencies.store(s_cast<u32>(predecessors.size()) + 1, std::memory_order_relaxed);
+        // counts as unfinished until it starts so block_on waits for the whole chain
+        task->not_finished.store(1, std::memory_order_release);
+
+        for(const auto& predecessor : predecessors) {
+            auto* continuation = new TaskContinuation {
+                .task = task,
+                .shared_data = shared_data.get(),
+                .priority = priority,
+                .task_class = task_class,
+                .next = {},
+            };
+
+            bool registered = false;
+            TaskContinuation* head = predecessor->continuations.load(std::memory_order_acquire);
+            while(head != &closed_continuations) {
+                continuation->next = head;
+                if(predecessor->continuations.compare_exchange_weak(head, continuation, std::memory_order_acq_rel, std::memory_order_acquire)) {
+                    registered = true;
+                    break;
+                }
             }
-            else { current_chunk_index = NO_MORE_CHUNKS_CODE; }
 
-            worked_on_last_chunk = (task->not_finished == 0);
+            if(!registered) {
+                delete continuation;
+                task->unfinished_dependencies.fetch_sub(1, std::memory_order_acq_rel);
+            }
         }
 
-        if (!worked_on_last_chunk) {
-            shared_data->work_done.wait(lock, [&] { return task->not_finished == 0; });
+        if(task->unfinished_dependencies.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            start_task(*shared_data, std::move(task), priority, task_class);
         }
     }
 
-    void ThreadPool::async_dispatch(std::shared_ptr<Task> task, TaskPriority priority) {
-        task->not_finished = task->chunk_count;
-        auto & selected_queue = priority == TaskPriority::HIGH ? shared_data->high_priority_tasks : shared_data->low_priority_tasks; 
-        {
-            std::lock_guard lock(shared_data->threadpool_mutex);
-            for (u32 chunk_index = 0; chunk_index < task->chunk_count; chunk_index++) {
-                selected_queue.push_back({task, chunk_index});
+    void ThreadPool::dispatch_inline_task(InlineTask* task, TaskPriority priority, TaskClass task_class) {
+        task->task_class = resolve_task_class(*shared_data, task_class);
+        reset_task(task);
+        enqueue_task(*shared_data, task, priority);
+    }
+
+    void ThreadPool::block_on(std::shared_ptr<Task> task) {
+        wait_until_finished(*shared_data, task.get());
+    }
+
+    auto ThreadPool::worker_count(TaskClass task_class) const -> u32 {
+        return shared_data->groups[s_cast<usize>(task_class)].worker_count;
+    }
+
+    auto ThreadPool::queued_entries(TaskClass task_class) const -> u32 {
+        return shared_data->groups[s_cast<usize>(task_class)].queued_entries.load(std::memory_order_relaxed);
+    }
+
+    auto ThreadPool::dropped_chunk_count() const -> u64 {
+        return shared_data->dropped_chunks.load(std::memory_order_relaxed);
+    }
+
+    auto ThreadPool::statistics() const -> ThreadPoolStatistics {
+        auto to_ms = [](const std::atomic<u64>& counter) { return s_cast<f64>(counter.load(std::memory_order_relaxed)) / 1'000'000.0; };
+
+        ThreadPoolStatistics ret = {};
+        ret.dropped_chunks = shared_data->dropped_chunks.load(std::memory_order_relaxed);
+        for(const auto& worker_data : shared_data->workers) {
+            const WorkerCounters& counters = worker_data->counters;
+            ThreadPoolWorkerStatistics worker_statistics = {
+                .task_class = worker_data->task_class,
+                .executed_entries = counters.executed_entries.load(std::memory_order_relaxed),
+                .steals = counters.steals.load(std::memory_order_relaxed),
+                .failed_steal_rounds = counters.failed_steal_rounds.load(std::memory_order_relaxed),
+                .busy_ms = to_ms(counters.busy_ns),
+                .idle_ms = to_ms(counters.idle_ns),
+                .injector_lock_wait_ms = to_ms(counters.injector_lock_wait_ns),
+                .queue_depth = {},
+            };
+
+            for(usize queue_index = 0; queue_index < PRIORITY_COUNT; queue_index++) {
+                const WorkStealingDeque& queue = worker_data->queues[queue_index];
+                i64 const depth = queue.bottom.load(std::memory_order_relaxed) - queue.top.load(std::memory_order_relaxed);
+                worker_statistics.queue_depth[queue_index] = s_cast<u32>(std::max<i64>(depth, 0));
             }
+
+            ret.workers.push_back(worker_statistics);
         }
 
-        shared_data->work_available.notify_all();
-    }
+        for(usize class_index = 0; class_index < TASK_CLASS_COUNT; class_index++) {
+            const WorkerGroup& group = shared_data->groups[class_index];
+            ret.queued_entries[class_index] = group.queued_entries.load(std::memory_order_relaxed);
+            for(usize queue_index = 0; queue_index < PRIORITY_COUNT; queue_index++) {
+                ret.injector_depth[class_index][queue_index] = group.injector_size[queue_index].load(std::memory_order_relaxed);
+            }
+        }
 
-    void ThreadPool::block_on(std::shared_ptr<Task> task) {
-        std::unique_lock lock{shared_data->threadpool_mutex};
-        shared_data->work_done.wait(lock, [&] { return task->not_finished == 0; });
+        return ret;
     }
 }
\ No newline at end of file
@@ -4,57 +4,296 @@
 #include <optional>
 #include <atomic>
 #include <deque>
-#include <condition_variable>
 #include <mutex>
+#include <vector>
+#include <algorithm>
+#include <new>
 
 namespace foundation {
     static constexpr u32 EXIT_CHUNK_CODE = std::numeric_limits<u32>::max();
     static constexpr u32 NO_MORE_CHUNKS_CODE = std::numeric_limits<u32>::max();
     static constexpr u32 EXTERNAL_THREAD_INDEX = std::numeric_limits<u32>::max();
+    static constexpr usize INLINE_TASK_PAYLOAD_SIZE = 192;
 
     enum struct TaskPriority {
         LOW,
         HIGH
     };
 
+    // every class is served by its own set of workers, blocking io cant starve cpu bound work and the other way around
+    enum struct TaskClass {
+        COMPUTE,
+        IO,
+        LATENCY_CRITICAL
+    };
+
+    static constexpr usize TASK_CLASS_COUNT = 3;
+
+    // where workers may run, ignored on platforms without topology information
+    struct ThreadPlacementInfo {
+        // every compute worker gets a cpu of its own instead of floating across all of them
+        bool pin_workers = false;
+        // one compute worker per physical core, also becomes the default compute thread count
+        bool avoid_smt_siblings = false;
+        // on hybrid parts compute and latency critical workers stay off the efficiency cores
+        bool prefer_performance_cores = false;
+        // restricts every worker to these cpus, empty means every cpu the process may run on
+        std::vector<u32> cpuset = {};
+    };
+
+    struct ThreadPoolInfo {
+        std::optional<u32> compute_thread_count = std::nullopt;
+        u32 io_thread_count = 2;
+        u32 latency_critical_thread_count = 1;
+        // queued entries after which try_async_dispatch and try_submit reject work, 0 means unbounded
+        std::array<u32, TASK_CLASS_COUNT> max_queued_entries = {};
+        ThreadPlacementInfo placement = {};
+    };
+
+    struct TaskContinuation;
+
+    struct ThreadPoolWorkerStatistics {
+        TaskClass task_class = {};
+        u64 executed_entries = {};
+        u64 steals = {};
+        u64 failed_steal_rounds = {};
+        f64 busy_ms = {};
+        f64 idle_ms = {};
+        f64 injector_lock_wait_ms = {};
+        std::array<u32, 2> queue_depth = {};
+    };
+
+    struct ThreadPoolStatistics {
+        std::vector<ThreadPoolWorkerStatistics> workers = {};
+        // indexed by task class and then priority, high priority first
+        std::array<std::array<u32, 2>, TASK_CLASS_COUNT> injector_depth = {};
+        std::array<u32, TASK_CLASS_COUNT> queued_entries = {};
+        u64 dropped_chunks = {};
+    };
+
+    // cooperative cancellation flag, copies share the same state and an empty token never cancels
+    struct CancellationToken {
+        static auto create() -> CancellationToken { return CancellationToken { .cancelled = std::make_shared<std::atomic<bool>>(false) }; }
+        void cancel() const { if(cancelled) { cancelled->store(true, std::memory_order_relaxed); } }
+        auto is_cancelled() const -> bool { return cancelled && cancelled->load(std::memory_order_relaxed); }
+
+        std::shared_ptr<std::atomic<bool>> cancelled = {};
+    };
+
     struct Task {
-        virtual ~Task() = default;
+        virtual ~Task();
         virtual void callback(u32 chunk_index, u32 thread_index) = 0;
+        // called once the pool dropped its last queued entry of the task
+        virtual void on_released();
 
         u32 chunk_count = {};
-        u32 not_finished = {};
-        u32 started = {};
+        TaskClass task_class = TaskClass::COMPUTE;
+        // chunks that didnt start before the token got cancelled are dropped without running the callback
+        CancellationToken cancellation = {};
+        std::atomic<u32> not_finished = {};
+        std::atomic<u32> started = {};
+
+        // every queued entry of this task holds one reference, the pool keeps the task alive until all of them are consumed
+        std::atomic<u32> references = {};
+        std::shared_ptr<Task> keep_alive = {};
+
+        // successors registered through ThreadPool::async_dispatch_after, the list gets closed once the task finishes
+        std::atomic<TaskContinuation*> continuations = {};
+        std::atomic<u32> unfinished_dependencies = {};
+    };
+
+    struct InlineTaskFreeList;
+
+    template<typename T>
+    struct Future;
+
+    // pooled task storing its callable in place, recycled through per thread free lists so submitting doesnt touch the heap
+    struct InlineTask : Task {
+        virtual void callback(u32 chunk_index, u32 thread_index) override;
+        virtual void on_released() override;
+
+        alignas(std::max_align_t) std::array<std::byte, INLINE_TASK_PAYLOAD_SIZE> payload = {};
+        void (*invoke)(void* payload) = {};
+        void (*destroy)(void* payload) = {};
+        InlineTaskFreeList* owner = {};
+        InlineTask* next_free = {};
     };
 
-    struct TaskChunk {
-        std::shared_ptr<Task> task = {};
-        u32 chunk_index = {};
+    auto acquire_inline_task() -> InlineTask*;
+
+    // hands out subranges with guided self scheduling, each claim takes a share of what is left so chunks shrink towards the end
+    struct ParallelRangeCursor {
+        std::atomic<usize> next = {};
+        usize end = {};
+        usize grain_size = {};
+        usize participant_count = {};
+
+        auto claim(usize& claimed_begin, usize& claimed_end) -> bool {
+            usize current = next.load(std::memory_order_relaxed);
+            while(current < end) {
+                usize const remaining = end - current;
+                usize const size = std::min(remaining, std::max(grain_size, remaining / (2 * participant_count)));
+                if(next.compare_exchange_weak(current, current + size, std::memory_order_relaxed)) {
+                    claimed_begin = current;
+                    claimed_end = current + size;
+                    return true;
+                }
+            }
+            return false;
+        }
     };
 
     struct ThreadPool {
     public:
-        ThreadPool(std::optional<u32> thread_count = std::nullopt);
+        ThreadPool(const ThreadPoolInfo& info = {});
         ThreadPool(ThreadPool &&) = default;
         ThreadPool & operator=(ThreadPool &&) = default;
         ThreadPool(ThreadPool const &) = delete;
         ThreadPool & operator=(ThreadPool const &) = delete;
         ~ThreadPool();
-        void blocking_dispatch(std::shared_ptr<Task> task, TaskPriority priority = TaskPriority::LOW);
-        void async_dispatch(std::shared_ptr<Task> task, TaskPriority priority = TaskPriority::LOW);
+        void blocking_dispatch(std::shared_ptr<Task> task, TaskPriority priority = TaskPriority::LOW, TaskClass task_class = TaskClass::COMPUTE);
+        void async_dispatch(std::shared_ptr<Task> task, TaskPriority priority = TaskPriority::LOW, TaskClass task_class = TaskClass::COMPUTE);
+        // same as async_dispatch but refuses the task when the queue of its class is full
+        auto try_async_dispatch(std::shared_ptr<Task> task, TaskPriority priority = TaskPriority::LOW, TaskClass task_class = TaskClass::COMPUTE) -> bool;
         void block_on(std::shared_ptr<Task> task);
+        // task becomes runnable once every predecessor finished, the thread finishing the last one schedules it
+        void async_dispatch_after(std::shared_ptr<Task> task, std::span<const std::shared_ptr<Task>> predecessors, TaskPriority priority = TaskPriority::LOW, TaskClass task_class = TaskClass::COMPUTE);
+        // fire and forget, fn() runs once on some worker, the callable has to fit into INLINE_TASK_PAYLOAD_SIZE
+        template<typename Fn>
+        void submit(Fn&& fn, TaskPriority priority = TaskPriority::LOW, TaskClass task_class = TaskClass::COMPUTE, CancellationToken cancellation = {});
+        template<typename Fn>
+        auto try_submit(Fn&& fn, TaskPriority priority = TaskPriority::LOW, TaskClass task_class = TaskClass::COMPUTE, CancellationToken cancellation = {}) -> bool;
+        void dispatch_inline_task(InlineTask* task, TaskPriority priority, TaskClass task_class);
+        // like submit but the return value of fn ends up in the returned future, defined in common/future.hpp
+        template<typename Fn>
+        auto submit_future(Fn&& fn, TaskPriority priority = TaskPriority::LOW, TaskClass task_class = TaskClass::COMPUTE) -> Future<std::invoke_result_t<std::decay_t<Fn>&>>;
+        auto has_queue_space(TaskClass task_class, u32 entry_count = 1) const -> bool;
 
+        // fn(index) is called for every index in [begin, end), the calling thread participates until the range is exhausted
+        template<typename Fn>
+        void parallel_for(usize begin, usize end, Fn&& fn, usize grain_size = 1, TaskPriority priority = TaskPriority::HIGH);
+        // fn(index) results are folded with combine, identity has to be the neutral element and combine associative and commutative
+        template<typename T, typename Fn, typename CombineFn>
+        auto parallel_reduce(usize begin, usize end, T identity, Fn&& fn, CombineFn&& combine, usize grain_size = 1, TaskPriority priority = TaskPriority::HIGH) -> T;
+
+        auto worker_count(TaskClass task_class = TaskClass::COMPUTE) const -> u32;
+        auto queued_entries(TaskClass task_class) const -> u32;
+        auto dropped_chunk_count() const -> u64;
+        // counters are cumulative since the pool got created, sampled without stopping the workers
+        auto statistics() const -> ThreadPoolStatistics;
+
+        struct SharedData;
     private:
-        struct SharedData {
-            std::condition_variable work_available = {};
-            std::condition_variable work_done = {};
-
-            std::mutex threadpool_mutex = {};
-            std::deque<TaskChunk> high_priority_tasks = {};
-            std::deque<TaskChunk> low_priority_tasks = {};
-            bool kill = false;
-        };
         static void worker(std::shared_ptr<ThreadPool::SharedData> shared_data, u32 thread_id);
         std::shared_ptr<SharedData> shared_data = {};
         std::vector<std::thread> worker_threads = {};
     };
+
+    template<typename Fn>
+    void ThreadPool::submit(Fn&& fn, TaskPriority priority, TaskClass task_class, CancellationToken cancellation) {
+        using Callable = std::decay_t<Fn>;
+        static_assert(sizeof(Callable) <= INLINE_TASK_PAYLOAD_SIZE, "callable doesnt fit into the inline task payload");
+        static_assert(alignof(Callable) <= alignof(std::max_align_t), "callable is over aligned for the inline task payload");
+
+        InlineTask* task = acquire_inline_task();
+        new (task->payload.data()) Callable(std::forward<Fn>(fn));
+        task->invoke = [](void* payload) { (*s_cast<Callable*>(payload))(); };
+        task->destroy = [](void* payload) { s_cast<Callable*>(payload)->~Callable(); };
+        task->cancellation = std::move(cancellation);
+        dispatch_inline_task(task, priority, task_class);
+    }
+
+    template<typename Fn>
+    auto ThreadPool::try_submit(Fn&& fn, TaskPriority priority, TaskClass task_class, CancellationToken cancellation) -> bool {
+        if(!has_queue_space(task_class)) { return false; }
+        submit(std::forward<Fn>(fn), priority, task_class, std::move(cancellation));
+        return true;
+    }
+
+    template<typename Fn>
+    struct ParallelForTask : Task {
+        ParallelRangeCursor cursor = {};
+        Fn* fn = {};
+
+        virtual void callback(u32 /*chunk_index*/, u32 /*thread_index*/) override {
+            usize range_begin = {};
+            usize range_end = {};
+            while(cursor.claim(range_begin, range_end)) {
+                for(usize index = range_begin; index < range_end; index++) {
+                    (*fn)(index);
+                }
+            }
+        }
+    };
+
+    template<typename T, typename Fn, typename CombineFn>
+    struct ParallelReduceTask : Task {
+        ParallelRangeCursor cursor = {};
+        Fn* fn = {};
+        CombineFn* combine = {};
+        std::vector<T> partial_results = {};
+
+        virtual void callback(u32 chunk_index, u32 /*thread_index*/) override {
+            T& accumulator = partial_results[chunk_index];
+            usize range_begin = {};
+            usize range_end = {};
+            while(cursor.claim(range_begin, range_end)) {
+                for(usize index = range_begin; index < range_end; index++) {
+                    accumulator = (*combine)(std::move(accumulator), (*fn)(index));
+                }
+            }
+        }
+    };
+
+    template<typename Fn>
+    void ThreadPool::parallel_for(usize begin, usize end, Fn&& fn, usize grain_size, TaskPriority priority) {
+        if(begin >= end) { return; }
+
+        grain_size = std::max(grain_size, usize{1});
+        if(end - begin <= grain_size) {
+            for(usize index = begin; index < end; index++) { fn(index); }
+            return;
+        }
+
+        // one chunk per participant, the chunks themselves pull subranges from the shared cursor
+        u32 const participant_count = s_cast<u32>(std::min<usize>(worker_count() + 1, (end - begin + grain_size - 1) / grain_size));
+        auto task = std::make_shared<ParallelForTask<std::remove_reference_t<Fn>>>();
+        task->cursor.next.store(begin, std::memory_order_relaxed);
+        task->cursor.end = end;
+        task->cursor.grain_size = grain_size;
+        task->cursor.participant_count = participant_count;
+        task->fn = &fn;
+        task->chunk_count = participant_count;
+        blocking_dispatch(task, priority);
+    }
+
+    template<typename T, typename Fn, typename CombineFn>
+    auto ThreadPool::parallel_reduce(usize begin, usize end, T identity, Fn&& fn, CombineFn&& combine, usize grain_size, TaskPriority priority) -> T {
+        if(begin >= end) { return identity; }
+
+        grain_size = std::max(grain_size, usize{1});
+        if(end - begin <= grain_size) {
+            T result = std::move(identity);
+            for(usize index = begin; index < end; index++) { result = combine(std::move(result), fn(index)); }
+            return result;
+        }
+
+        u32 const participant_count = s_cast<u32>(std::min<usize>(worker_count() + 1, (end - begin + grain_size - 1) / grain_size));
+        auto task = std::make_shared<ParallelReduceTask<T, std::remove_reference_t<Fn>, std::remove_reference_t<CombineFn>>>();
+        task->cursor.next.store(begin, std::memory_order_relaxed);
+        task->cursor.end = end;
+        task->cursor.grain_size = grain_size;
+        task->cursor.participant_count = participant_count;
+        task->fn = &fn;
+        task->combine = &combine;
+        task->partial_results.resize(participant_count, identity);
+        task->chunk_count = participant_count;
+        blocking_dispatch(task, priority);
+
+        T result = std::move(identity);
+        for(T& partial_result : task->partial_results) {
+            result = combine(std::move(result), std::move(partial_result));
+        }
+        return result;
+    }
 }
\ No newline at end of file
@@ -0,0 +1,258 @@
+#include <ecs/asset_converter.hpp>
+#include <ecs/cook_cache.hpp>
+#include <common/future.hpp>
+#include <fstream>
+#include <sstream>
+#include <charconv>
+
+// headless batch cooker, converts gltf models to .bmodel without a window or gpu
+//
+// usage: foundation_cook [options] <input.gltf> <output.bmodel> [<input> <output>...]
+//   --manifest <file>   reads additional "input output" pairs, one per line, # starts a comment
+//   --workers <count>   compute workers of the thread pool, defaults to one per hardware thread
+//   --store <dir>       shared content addressed store for every model
+//   --no-cache          ignores and doesnt update the cook cache
+//   --memory-budget <mib>  streams external buffers and keeps the estimated working set of every model under this size
+//   --texture-encoder <nvtt|native>  native trades some quality for a much faster cook of bc1/bc4/bc5 textures, defaults to nvtt
+//   --texture-quality   prints the psnr of every compressed texture and the time it took
+//   --compare-placement  cooks everything once per thread placement policy without the cook cache and prints the time each took
+
+using namespace foundation;
+
+struct CookJob {
+    std::filesystem::path input_path = {};
+    std::filesystem::path output_path = {};
+};
+
+struct CookResult {
+    bool succeeded = {};
+    f64 elapsed_ms = {};
+};
+
+struct PlacementPolicy {
+    std::string_view name = {};
+    ThreadPlacementInfo placement = {};
+};
+
+// compared by --compare-placement, floating is what the cooker uses otherwise
+static const std::array<PlacementPolicy, 4> PLACEMENT_POLICIES = {
+    PlacementPolicy { .name = "floating", .placement = {} },
+    PlacementPolicy { .name = "pinned", .placement = { .pin_workers = true } },
+    PlacementPolicy { .name = "pinned physical cores", .placement = { .pin_workers = true, .avoid_smt_siblings = true } },
+    PlacementPolicy { .name = "performance cores", .placement = { .prefer_performance_cores = true } },
+};
+
+static void print_usage() {
+    fmt::println("usage: foundation_cook [--manifest <file>] [--workers <count>] [--store <dir>] [--no-cache] [--memory-budget <mib>] [--texture-encoder <nvtt|native>] [--texture-quality] [--compare-placement] [<input.gltf> <output.bmodel>]...");
+}
+
+// the whole value has to be a number, zero is raised to one
+static auto parse_count(std::string_view value) -> std::optional<u64> {
+    u64 count = 0;
+    auto const [end, error] = std::from_chars(value.data(), value.data() + value.size(), count);
+    if(error != std::errc{} || end != value.data() + value.size()) { return std::nullopt; }
+    return std::max(count, u64{1});
+}
+
+static auto read_manifest(const std::filesystem::path& path, std::vector<CookJob>& jobs) -> bool {
+    std::ifstream file(path);
+    if(!file) {
+        fmt::println("couldnt open manifest: {}", path.string());
+        return false;
+    }
+
+    std::string line = {};
+    u32 line_number = 0;
+    while(std::getline(file, line)) {
+        line_number++;
+        line = line.substr(0, line.find('#'));
+
+        std::istringstream stream(line);
+        std::string input = {};
+        std::string output = {};
+        if(!(stream >> input)) { continue; }
+        if(!(stream >> output)) {
+            fmt::println("{}:{} - expected an input and an output path", path.string(), line_number);
+            return false;
+        }
+
+        // relative paths in a manifest are relative to the manifest itself
+        jobs.push_back(CookJob {
+            .input_path = path.parent_path() / input,
+            .output_path = path.parent_path() / output,
+        });
+    }
+    return true;
+}
+
+// cooks every job on the pool, results are indexed like jobs
+static auto cook_jobs(const std::vector<CookJob>& jobs, const ConverterSettings& settings, ThreadPool& thread_pool) -> std::vector<CookResult> {
+    // models sharing a store share its cook cache, it is loaded once before and saved once after all of them so they can cook concurrently
+    std::vector<CookCache> store_caches = {};
+    std::vector<u32> job_store_indices(jobs.size());
+    for(u32 job_index = 0; job_index < jobs.size(); job_index++) {
+        std::filesystem::path const store_directory = std::filesystem::weakly_canonical(settings.store_directory.value_or(jobs[job_index].output_path.parent_path()));
+        auto store_cache = std::ranges::find(store_caches, store_directory, &CookCache::directory);
+        if(store_cache == store_caches.end()) {
+            store_caches.push_back(settings.use_cook_cache ? CookCache::load(store_directory) : CookCache { .directory = store_directory });
+            store_cache = store_caches.end() - 1;
+        }
+        job_store_indices[job_index] = s_cast<u32>(store_cache - store_caches.begin());
+    }
+
+    std::vector<CookResult> results(jobs.size());
+    std::vector<Future<void>> job_futures = {};
+    for(u32 job_index = 0; job_index < jobs.size(); job_index++) {
+        job_futures.push_back(thread_pool.submit_future([&jobs, &results, &settings, &thread_pool, cook_cache = &store_caches[job_store_indices[job_index]], job_index]() {
+            const CookJob& job = jobs[job_index];
+            auto const job_start_time = std::chrono::steady_clock::now();
+            fmt::println("cooking {} -> {}", job.input_path.string(), job.output_path.string());
+
+            ConverterSettings job_settings = settings;
+            job_settings.cook_cache = cook_cache;
+            try {
+                AssetConverter::convert_gltf_to_binary(job.input_path, job.output_path, &thread_pool, job_settings);
+                results[job_index].succeeded = true;
+            } catch(const std::exception& e) {
+                fmt::println("failed to cook {}: {}", job.input_path.string(), e.what());
+            }
+            results[job_index].elapsed_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - job_start_time).count();
+        }));
+    }
+    when_all(&thread_pool, std::span{job_futures}).get();
+
+    if(settings.use_cook_cache) {
+        for(const CookCache& cook_cache : store_caches) {
+            // every model of a store can fail before the converter created its directory
+            if(std::filesystem::exists(cook_cache.directory)) { cook_cache.save(); }
+        }
+    }
+
+    return results;
+}
+
+auto main(i32 argc, char** argv) -> i32 {
+    PROFILE_SCOPE;
+
+    std::vector<CookJob> jobs = {};
+    std::optional<u32> worker_count = std::nullopt;
+    ConverterSettings settings = {};
+    bool compare_placement = false;
+
+    std::vector<std::string> positional = {};
+    for(i32 i = 1; i < argc; i++) {
+        std::string_view const arg = argv[i];
+        bool const has_value = i + 1 < argc;
+
+        if(arg == "--manifest" && has_value) {
+            if(!read_manifest(argv[++i], jobs)) { return 1; }
+        } else if(arg == "--workers" && has_value) {
+            std::optional<u64> const count = parse_count(argv[++i]);
+            if(!count.has_value() || count.value() > std::numeric_limits<u32>::max()) {
+                fmt::println("invalid worker count: {}", argv[i]);
+                print_usage();
+                return 1;
+            }
+            worker_count = s_cast<u32>(count.value());
+        } else if(arg == "--store" && has_value) {
+            settings.store_directory = std::filesystem::path(argv[++i]);
+        } else if(arg == "--memory-budget" && has_value) {
+            std::optional<u64> const mebibytes = parse_count(argv[++i]);
+            if(!mebibytes.has_value() || mebibytes.value() > (std::numeric_limits<u64>::max() >> 20)) {
+                fmt::println("invalid memory budget: {}", argv[i]);
+                print_usage();
+                return 1;
+            }
+            settings.memory_budget = mebibytes.value() << 20;
+        } else if(arg == "--texture-encoder" && has_value) {
+            std::string_view const encoder = argv[++i];
+            if(encoder == "nvtt") {
+                settings.texture_encoder = TextureEncoder::Nvtt;
+            } else if(encoder == "native") {
+                settings.texture_encoder = TextureEncoder::Native;
+            } else {
+                fmt::println("unknown texture encoder: {}", encoder);
+                print_usage();
+                return 1;
+            }
+        } else if(arg == "--texture-quality") {
+            settings.report_texture_quality = true;
+        } else if(arg == "--no-cache") {
+            settings.use_cook_cache = false;
+        } else if(arg == "--compare-placement") {
+            compare_placement = true;
+        } else if(arg == "--help" || arg == "-h") {
+            print_usage();
+            return 0;
+        } else if(arg.starts_with("--")) {
+            fmt::println("unknown option: {}", arg);
+            print_usage();
+            return 1;
+        } else {
+            positional.emplace_back(arg);
+        }
+    }
+
+    if(positional.size() % 2 != 0) {
+        fmt::println("missing output path for {}", positional.back());
+        print_usage();
+        return 1;
+    }
+    for(usize i = 0; i < positional.size(); i += 2) {
+        jobs.push_back(CookJob { .input_path = positional[i], .output_path = positional[i + 1] });
+    }
+
+    if(jobs.empty()) {
+        print_usage();
+        return 1;
+    }
+
+    if(compare_placement) {
+        // every policy has to do the whole conversion, with the cache only the first run would
+        settings.use_cook_cache = false;
+
+        std::vector<std::string> summary = {};
+        u32 failed_count = 0;
+        for(const PlacementPolicy& policy : PLACEMENT_POLICIES) {
+            fmt::println("placement: {}", policy.name);
+            ThreadPool thread_pool(ThreadPoolInfo {
+                .compute_thread_count = worker_count,
+                .io_thread_count = 0,
+                .latency_critical_thread_count = 0,
+                .placement = policy.placement,
+            });
+
+            auto const start_time = std::chrono::steady_clock::now();
+            std::vector<CookResult> const results = cook_jobs(jobs, settings, thread_pool);
+            f64 const elapsed_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+
+            u32 const policy_failed_count = s_cast<u32>(std::ranges::count(results, false, &CookResult::succeeded));
+            failed_count += policy_failed_count;
+            summary.push_back(fmt::format("{:>10.1f} ms  {:>3} workers  {} failed  {}", elapsed_ms, thread_pool.worker_count(), policy_failed_count, policy.name));
+        }
+
+        fmt::println("");
+        for(const std::string& line : summary) { fmt::println("{}", line); }
+        return failed_count == 0 ? 0 : 1;
+    }
+
+    ThreadPool thread_pool(ThreadPoolInfo {
+        .compute_thread_count = worker_count,
+        .io_thread_count = 0,
+        .latency_critical_thread_count = 0,
+    });
+
+    auto const start_time = std::chrono::steady_clock::now();
+    std::vector<CookResult> const results = cook_jobs(jobs, settings, thread_pool);
+    f64 const elapsed_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+
+    u32 failed_count = 0;
+    fmt::println("");
+    for(u32 job_index = 0; job_index < jobs.size(); job_index++) {
+        fmt::println("{:>10.1f} ms  {}  {}", results[job_index].elapsed_ms, results[job_index].succeeded ? "ok    " : "failed", jobs[job_index].input_path.string());
+        if(!results[job_index].succeeded) { failed_count++; }
+    }
+    fmt::println("cooked {} of {} models on {} workers in {:.1f} ms", jobs.size() - failed_count, jobs.size(), thread_pool.worker_count(), elapsed_ms);
+
+    return failed_count == 0 ? 0 : 1;
+}
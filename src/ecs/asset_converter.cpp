@@ -0,0 +1,2338 @@
+#include "asset_converter.hpp"
+#define STB_IMAGE_IMPLEMENTATION
+#include <stb_image.h>
+#include <meshoptimizer.h>
+#include <fastgltf/tools.hpp>
+#include <fastgltf/glm_element_traits.hpp>
+#include <shader_library/vertex_compression.inl>
+#include <utils/zstd.hpp>
+#include <fastgltf/core.hpp>
+#include <fastgltf/types.hpp>
+
+#include <glm/ext/quaternion_geometric.hpp>
+#include <glm/gtc/matrix_transform.hpp>
+#include <glm/gtx/quaternion.hpp>
+
+#define GLM_ENABLE_EXPERIMENTAL
+#include <glm/gtx/matrix_decompose.hpp>
+
+#include <math/decompose.hpp>
+#include <utils/file_io.hpp>
+#include <utils/hash.hpp>
+#include <utils/pixel_kernels.hpp>
+#include <utils/block_compression.hpp>
+#include <utils/texture_container.hpp>
+#include <ecs/cook_cache.hpp>
+#include <common/memory_usage.hpp>
+
+#include <numeric>
+#include <bit>
+#include <memory_resource>
+#include <condition_variable>
+#include <metis.h>
+
+#if defined(__clang__)
+#pragma clang diagnostic push
+#pragma clang diagnostic ignored "-Wold-style-cast"
+#include <nvtt/nvtt.h>
+#pragma clang diagnostic pop
+#endif
+
+static constexpr i32 TARGET_MESHLETS_PER_GROUP = 8;
+static constexpr f32 SIMPLIFICATION_FAILURE_PERCENTAGE = 0.95f;
+static constexpr usize MESHLET_GRAIN_SIZE = 16;
+static constexpr usize PIXEL_GRAIN_SIZE = 16384;
+// lod arena chunks go back to these pools when released, big chunks included so the next level reuses them
+static constexpr std::pmr::pool_options ARENA_POOL_OPTIONS = { .max_blocks_per_chunk = 4, .largest_required_pool_block = usize{64} << 20 };
+// part of every cook cache key, bump when process_mesh or the texture compression changes its output
+static constexpr u32 MESH_COOK_VERSION = 1;
+static constexpr u32 TEXTURE_COOK_VERSION = 1;
+// rough working set of process_mesh relative to its accessor data, remapping, meshlets and every lod level hold their own copies
+static constexpr u64 PRIMITIVE_MEMORY_FACTOR = 8;
+// rgba8 decode, split off single channel planes and two float4 nvtt surfaces
+static constexpr u64 IMAGE_BYTES_PER_PIXEL = 40;
+// stb decodes to rgba, nvtt takes bgra
+static constexpr std::array<u8, 4> BGRA_FROM_RGBA = { 2, 1, 0, 3 };
+
+namespace foundation {
+    // buffer view source for fastgltf::copyFromAccessor, external buffers that werent loaded with the asset only get the viewed range read from disk
+    struct BufferViewReader {
+        std::filesystem::path asset_directory = {};
+        // read ranges live as long as the reader, vectors keep their storage when the map grows
+        mutable ankerl::unordered_dense::map<usize, std::vector<std::byte>> read_views = {};
+
+        auto operator()(const fastgltf::Asset& asset, usize buffer_view_index) const -> fastgltf::span<const std::byte> {
+            const fastgltf::BufferView& buffer_view = asset.bufferViews[buffer_view_index];
+            const fastgltf::Buffer& buffer = asset.buffers[buffer_view.bufferIndex];
+            const auto* uri = std::get_if<fastgltf::sources::URI>(&buffer.data);
+            if(uri == nullptr) { return fastgltf::DefaultBufferDataAdapter{}(asset, buffer_view_index); }
+
+            auto [entry, inserted] = read_views.try_emplace(buffer_view_index);
+            if(inserted) {
+                std::filesystem::path path{uri->uri.path().begin(), uri->uri.path().end()};
+                if(uri->uri.isLocalPath()) { path = asset_directory / path; }
+                entry->second = read_file_range_to_bytes(path, uri->fileByteOffset + buffer_view.byteOffset, buffer_view.byteLength);
+            }
+            return { entry->second.data(), entry->second.size() };
+        }
+    };
+
+    // bytes reading an image source pulls into memory, claimed before the read
+    static auto image_source_bytes(const fastgltf::Asset& asset, const std::filesystem::path& asset_directory, const fastgltf::DataSource& data) -> u64 {
+        return std::visit(fastgltf::visitor {
+            [&](const fastgltf::sources::BufferView& source) -> u64 { return asset.bufferViews[source.bufferViewIndex].byteLength; },
+            [&](const fastgltf::sources::URI& source) -> u64 {
+                std::filesystem::path path{source.uri.path().begin(), source.uri.path().end()};
+                if(source.uri.isLocalPath()) { path = asset_directory / path; }
+                std::error_code error = {};
+                u64 const size = std::filesystem::file_size(path, error);
+                return error ? 0 : size;
+            },
+            [&](const fastgltf::sources::Array& source) -> u64 { return source.bytes.size_bytes(); },
+            [&](const fastgltf::sources::Vector& source) -> u64 { return source.bytes.size(); },
+            [&](const fastgltf::sources::ByteView& source) -> u64 { return source.bytes.size(); },
+            [&](const auto& /* source */) -> u64 { return 0; },
+        }, data);
+    }
+
+    // claims of the current thread across every budget, see MemoryBudget::acquire
+    static thread_local u32 memory_claims_held = 0;
+
+    // estimated bytes of decoded inputs and intermediates in flight, without a ceiling it only tracks the peak
+    struct MemoryBudget {
+        std::optional<u64> ceiling = std::nullopt;
+        std::mutex mutex = {};
+        std::condition_variable released = {};
+        u64 in_use = {};
+        u64 peak = {};
+        // claims of threads blocked in grow
+        u64 held_by_growing = {};
+
+        // a claim larger than the ceiling still goes through once nothing else is in flight
+        void acquire(u64 bytes) {
+            std::unique_lock lock{mutex};
+            // a thread holding a claim can pick up another item while it waits on its own nested work, blocking it here could never end
+            if(ceiling.has_value() && memory_claims_held == 0) {
+                released.wait(lock, [&]() { return in_use == 0 || in_use + bytes <= ceiling.value(); });
+            }
+            in_use += bytes;
+            peak = std::max(peak, in_use);
+            memory_claims_held++;
+        }
+
+        // adds to a claim of held bytes the thread already has, waits like acquire unless every claimed byte belongs to a thread
+        // that is itself waiting to grow, those would otherwise wait on each other forever
+        void grow(u64 held, u64 bytes) {
+            std::unique_lock lock{mutex};
+            if(ceiling.has_value() && memory_claims_held == 1) {
+                held_by_growing += held;
+                released.notify_all();
+                released.wait(lock, [&]() { return in_use + bytes <= ceiling.value() || in_use == held_by_growing; });
+                held_by_growing -= held;
+            }
+            in_use += bytes;
+            peak = std::max(peak, in_use);
+        }
+
+        void release(u64 bytes) {
+            {
+                std::lock_guard lock{mutex};
+                in_use -= bytes;
+            }
+            memory_claims_held--;
+            released.notify_all();
+        }
+
+        // peak since the last call, the next stage starts from whatever is still claimed
+        auto take_peak() -> u64 {
+            std::lock_guard lock{mutex};
+            return std::exchange(peak, in_use);
+        }
+    };
+
+    struct MemoryClaim {
+        MemoryClaim(MemoryBudget& budget, u64 bytes) : budget{budget}, bytes{bytes} { budget.acquire(bytes); }
+        MemoryClaim(const MemoryClaim&) = delete;
+        MemoryClaim& operator=(const MemoryClaim&) = delete;
+        ~MemoryClaim() { budget.release(bytes); }
+
+        void extend(u64 extra_bytes) {
+            budget.grow(bytes, extra_bytes);
+            bytes += extra_bytes;
+        }
+
+        MemoryBudget& budget;
+        u64 bytes = {};
+    };
+
+    template <typename ElemT, bool IS_INDEX_BUFFER>
+    auto load_data(fastgltf::Asset& asset, fastgltf::Accessor& accessor, const std::filesystem::path& asset_directory) {
+        BufferViewReader const buffer_views{ .asset_directory = asset_directory };
+        std::vector<ElemT> ret(accessor.count);
+        if constexpr(IS_INDEX_BUFFER) {
+            if (accessor.componentType == fastgltf::ComponentType::UnsignedShort) {
+                std::vector<u16> u16_index_buffer(accessor.count);
+                fastgltf::copyFromAccessor<u16>(asset, accessor, u16_index_buffer.data(), buffer_views);
+                for (usize i = 0; i < u16_index_buffer.size(); ++i) {
+                    ret[i] = s_cast<u32>(u16_index_buffer[i]);
+                }
+            }
+            else {
+                fastgltf::copyFromAccessor<u32>(asset, accessor, ret.data(), buffer_views);
+            }
+        } else {
+            fastgltf::copyFromAccessor<ElemT>(asset, accessor, ret.data(), buffer_views);
+        }
+
+        return ret;
+    }
+
+    // hands fn(first_pixel, pixel_count) chunks of PIXEL_GRAIN_SIZE pixels to the pool
+    template <typename Fn>
+    static void for_each_pixel_chunk(ThreadPool* thread_pool, usize pixel_count, const Fn& fn) {
+        usize const chunk_count = (pixel_count + PIXEL_GRAIN_SIZE - 1) / PIXEL_GRAIN_SIZE;
+        thread_pool->parallel_for(0, chunk_count, [&](usize chunk) {
+            usize const first_pixel = chunk * PIXEL_GRAIN_SIZE;
+            fn(first_pixel, std::min(PIXEL_GRAIN_SIZE, pixel_count - first_pixel));
+        });
+    }
+
+    // format the blocks of a dds or ktx2 image can be stored as untouched, the loader expects the full mip chain
+    static auto passthrough_format(const CompressedImage& image, MaterialType material_type, bool create_alpha_mask) -> std::optional<daxa::Format> {
+        if(image.mipmaps.size() != s_cast<usize>(std::bit_width(std::max(image.width, image.height)))) { return std::nullopt; }
+
+        bool const bc1 = image.format == daxa::Format::BC1_RGB_UNORM_BLOCK || image.format == daxa::Format::BC1_RGB_SRGB_BLOCK ||
+                         image.format == daxa::Format::BC1_RGBA_UNORM_BLOCK || image.format == daxa::Format::BC1_RGBA_SRGB_BLOCK;
+        bool const bc7 = image.format == daxa::Format::BC7_UNORM_BLOCK || image.format == daxa::Format::BC7_SRGB_BLOCK;
+        // gltf color textures are srgb whatever the container claims, fourcc dds files cant even say so
+        bool const color = (material_type == MaterialType::GltfAlbedo && !create_alpha_mask) || material_type == MaterialType::GltfEmissive;
+        if(color && bc1) { return daxa::Format::BC1_RGB_SRGB_BLOCK; }
+        // bc7 cant be decoded here, but the loader takes whatever format the texture file names
+        if(color && bc7) { return daxa::Format::BC7_SRGB_BLOCK; }
+        if(material_type == MaterialType::GltfNormal && image.format == daxa::Format::BC5_UNORM_BLOCK) { return daxa::Format::BC5_UNORM_BLOCK; }
+        // roughness and metalness always get split and the alpha mask always gets its own texture
+        return std::nullopt;
+    }
+
+#pragma region NATIVE TEXTURE ENCODING
+    static auto srgb_to_linear(std::byte value) -> f32 {
+        static std::array<f32, 256> const table = []() {
+            std::array<f32, 256> values = {};
+            for(u32 i = 0; i < values.size(); i++) {
+                f32 const srgb = s_cast<f32>(i) / 255.0f;
+                values[i] = srgb <= 0.04045f ? srgb / 12.92f : std::pow((srgb + 0.055f) / 1.055f, 2.4f);
+            }
+            return values;
+        }();
+        return table[s_cast<u8>(value)];
+    }
+
+    static auto linear_to_srgb(f32 value) -> std::byte {
+        // finer than 8 bits in the darks where srgb spends most of its codes
+        static std::array<u8, 4096> const table = []() {
+            std::array<u8, 4096> values = {};
+            for(u32 i = 0; i < values.size(); i++) {
+                f32 const linear = s_cast<f32>(i) / s_cast<f32>(values.size() - 1);
+                f32 const srgb = linear <= 0.0031308f ? linear * 12.92f : 1.055f * std::pow(linear, 1.0f / 2.4f) - 0.055f;
+                values[i] = s_cast<u8>(std::lround(srgb * 255.0f));
+            }
+            return values;
+        }();
+        return std::byte{table[s_cast<usize>(std::lround(std::clamp(value, 0.0f, 1.0f) * s_cast<f32>(table.size() - 1)))]};
+    }
+
+    // 2x2 box filter down to the next mip size, a trailing odd row or column is dropped, srgb only applies to rgb
+    static auto downsample_rgba8(std::span<const std::byte> pixels, u32 width, u32 height, bool srgb, ThreadPool* thread_pool) -> std::vector<std::byte> {
+        u32 const next_width = std::max(width / 2, 1u);
+        u32 const next_height = std::max(height / 2, 1u);
+        std::vector<std::byte> next(usize{next_width} * next_height * 4);
+        thread_pool->parallel_for(0, next_height, [&](usize y) {
+            usize const row0 = std::min(y * 2, usize{height} - 1) * width;
+            usize const row1 = std::min(y * 2 + 1, usize{height} - 1) * width;
+            for(usize x = 0; x < next_width; x++) {
+                usize const column0 = std::min(x * 2, usize{width} - 1);
+                usize const column1 = std::min(x * 2 + 1, usize{width} - 1);
+                std::array<usize, 4> const texels = { row0 + column0, row0 + column1, row1 + column0, row1 + column1 };
+                for(usize channel = 0; channel < 4; channel++) {
+                    std::byte& destination = next[(y * next_width + x) * 4 + channel];
+                    if(srgb && channel < 3) {
+                        f32 sum = 0.0f;
+                        for(usize texel : texels) { sum += srgb_to_linear(pixels[texel * 4 + channel]); }
+                        destination = linear_to_srgb(sum * 0.25f);
+                    } else {
+                        u32 sum = 0;
+                        for(usize texel : texels) { sum += s_cast<u32>(pixels[texel * 4 + channel]); }
+                        destination = s_cast<std::byte>((sum + 2) / 4);
+                    }
+                }
+            }
+        });
+        return next;
+    }
+
+    static auto downsample_plane(std::span<const std::byte> plane, u32 width, u32 height, ThreadPool* thread_pool) -> std::vector<std::byte> {
+        u32 const next_width = std::max(width / 2, 1u);
+        u32 const next_height = std::max(height / 2, 1u);
+        std::vector<std::byte> next(usize{next_width} * next_height);
+        thread_pool->parallel_for(0, next_height, [&](usize y) {
+            usize const row0 = std::min(y * 2, usize{height} - 1) * width;
+            usize const row1 = std::min(y * 2 + 1, usize{height} - 1) * width;
+            for(usize x = 0; x < next_width; x++) {
+                usize const column0 = std::min(x * 2, usize{width} - 1);
+                usize const column1 = std::min(x * 2 + 1, usize{width} - 1);
+                u32 const sum = s_cast<u32>(plane[row0 + column0]) + s_cast<u32>(plane[row0 + column1]) + s_cast<u32>(plane[row1 + column0]) + s_cast<u32>(plane[row1 + column1]);
+                next[y * next_width + x] = s_cast<std::byte>((sum + 2) / 4);
+            }
+        });
+        return next;
+    }
+
+    // tangent space normals stored as unorm rgb get unit length again, zero length ones point straight out of the surface
+    static void normalize_normal_map(std::span<std::byte> rgba, ThreadPool* thread_pool) {
+        for_each_pixel_chunk(thread_pool, rgba.size() / 4, [&](usize first_pixel, usize pixel_count) {
+            for(usize pixel = first_pixel; pixel < first_pixel + pixel_count; pixel++) {
+                std::byte* texel = rgba.data() + pixel * 4;
+                glm::vec3 normal = glm::vec3{ s_cast<f32>(texel[0]), s_cast<f32>(texel[1]), s_cast<f32>(texel[2]) } / 127.5f - 1.0f;
+                f32 const length = glm::length(normal);
+                normal = length > 0.0f ? normal / length : glm::vec3{ 0.0f, 0.0f, 1.0f };
+                for(usize channel = 0; channel < 3; channel++) {
+                    texel[channel] = s_cast<std::byte>(std::lround((normal[s_cast<glm::length_t>(channel)] + 1.0f) * 127.5f));
+                }
+            }
+        });
+    }
+
+    // fraction of the plane above cutoff, cutoff is in [0, 1]
+    static auto alpha_coverage(std::span<const std::byte> plane, f32 cutoff) -> f32 {
+        u32 const threshold = s_cast<u32>(std::clamp(cutoff, 0.0f, 1.0f) * 255.0f);
+        usize const covered = s_cast<usize>(std::ranges::count_if(plane, [threshold](std::byte value) { return s_cast<u32>(value) > threshold; }));
+        return plane.empty() ? 0.0f : s_cast<f32>(covered) / s_cast<f32>(plane.size());
+    }
+
+    // scales the plane so the cutoff covers as much as it did on the top mip, otherwise alpha tested foliage thins out in the distance
+    static void scale_alpha_to_coverage(std::span<std::byte> plane, f32 coverage, f32 cutoff, ThreadPool* thread_pool) {
+        std::array<usize, 256> histogram = {};
+        for(std::byte value : plane) { histogram[s_cast<u8>(value)]++; }
+
+        // coverage after scaling only depends on the histogram, the scale is bisected the way nvtt does it
+        u32 const threshold = s_cast<u32>(std::clamp(cutoff, 0.0f, 1.0f) * 255.0f);
+        auto scaled_coverage = [&](f32 scale) -> f32 {
+            usize covered = 0;
+            for(u32 value = 0; value < histogram.size(); value++) {
+                if(std::min(std::lround(s_cast<f32>(value) * scale), 255l) > s_cast<long>(threshold)) { covered += histogram[value]; }
+            }
+            return s_cast<f32>(covered) / s_cast<f32>(plane.size());
+        };
+
+        // coverage moves in steps, the closest scale seen wins rather than the last one
+        f32 min_scale = 0.0f;
+        f32 max_scale = 4.0f;
+        f32 scale = 1.0f;
+        f32 best_scale = 1.0f;
+        f32 best_error = std::numeric_limits<f32>::max();
+        for(u32 iteration = 0; iteration < 10; iteration++) {
+            f32 const current_coverage = scaled_coverage(scale);
+            if(std::abs(current_coverage - coverage) < best_error) {
+                best_error = std::abs(current_coverage - coverage);
+                best_scale = scale;
+            }
+
+            if(current_coverage < coverage) { min_scale = scale; }
+            else if(current_coverage > coverage) { max_scale = scale; }
+            else { break; }
+            scale = (min_scale + max_scale) * 0.5f;
+        }
+
+        for_each_pixel_chunk(thread_pool, plane.size(), [&](usize first_pixel, usize pixel_count) {
+            for(std::byte& value : plane.subspan(first_pixel, pixel_count)) {
+                value = s_cast<std::byte>(std::min(std::lround(s_cast<f32>(value) * best_scale), 255l));
+            }
+        });
+    }
+
+    // encode(width, height) compresses the current level, next_mip(width, height) replaces it with the level below
+    template <typename EncodeFn, typename NextMipFn>
+    static auto encode_native_mip_chain(u32 width, u32 height, daxa::Format format, const EncodeFn& encode, const NextMipFn& next_mip) -> BinaryTextureFileFormat {
+        BinaryTextureFileFormat texture {
+            .width = width,
+            .height = height,
+            .depth = 1,
+            .format = format,
+            .mipmaps = {}
+        };
+
+        u32 const mip_count = s_cast<u32>(std::bit_width(std::max(width, height)));
+        u32 mip_width = width;
+        u32 mip_height = height;
+        for(u32 mip = 0; mip < mip_count; mip++) {
+            texture.mipmaps.push_back(encode(mip_width, mip_height));
+            if(mip == mip_count - 1) { break; }
+
+            next_mip(mip_width, mip_height);
+            mip_width = std::max(mip_width / 2, 1u);
+            mip_height = std::max(mip_height / 2, 1u);
+        }
+        return texture;
+    }
+
+    // psnr of the top mip against the reference rgba8 channels, bc1 compares them with rgb, bc4 with red and bc5 with red and green
+    static auto measure_top_mip_psnr(const BinaryTextureFileFormat& texture, std::span<const std::byte> reference_rgba, std::span<const u32> reference_channels) -> std::optional<f64> {
+        if(reference_channels.empty()) { return std::nullopt; }
+
+        std::vector<std::byte> decoded = {};
+        usize decoded_channel_count = 0;
+        switch(texture.format) {
+            case daxa::Format::BC1_RGB_SRGB_BLOCK:
+            case daxa::Format::BC1_RGB_UNORM_BLOCK: { decoded = decode_bc1(texture.mipmaps[0], texture.width, texture.height); decoded_channel_count = 4; break; }
+            case daxa::Format::BC4_UNORM_BLOCK: { decoded = decode_bc4(texture.mipmaps[0], texture.width, texture.height); decoded_channel_count = 1; break; }
+            case daxa::Format::BC5_UNORM_BLOCK: { decoded = decode_bc5(texture.mipmaps[0], texture.width, texture.height); decoded_channel_count = 2; break; }
+            default: return std::nullopt;
+        }
+
+        usize const pixel_count = usize{texture.width} * texture.height;
+        f64 squared_error = 0.0;
+        for(usize pixel = 0; pixel < pixel_count; pixel++) {
+            for(usize channel = 0; channel < reference_channels.size(); channel++) {
+                f64 const difference = s_cast<f64>(decoded[pixel * decoded_channel_count + channel]) - s_cast<f64>(reference_rgba[pixel * 4 + reference_channels[channel]]);
+                squared_error += difference * difference;
+            }
+        }
+
+        f64 const mean_squared_error = squared_error / s_cast<f64>(pixel_count * reference_channels.size());
+        if(mean_squared_error == 0.0) { return std::numeric_limits<f64>::infinity(); }
+        return 10.0 * std::log10(255.0 * 255.0 / mean_squared_error);
+    }
+#pragma endregion
+
+    // decoded size of the accessors process_mesh reads
+    static auto primitive_input_bytes(const fastgltf::Asset& asset, u32 mesh_index, u32 primitive_index) -> u64 {
+        const fastgltf::Primitive& primitive = asset.meshes[mesh_index].primitives[primitive_index];
+
+        u64 bytes = 0;
+        for(auto [attribute, element_size] : { std::pair{ "POSITION", sizeof(glm::vec3) }, std::pair{ "NORMAL", sizeof(glm::vec3) }, std::pair{ "TEXCOORD_0", sizeof(glm::vec2) } }) {
+            const auto* attribute_iter = primitive.findAttribute(attribute);
+            if(attribute_iter != primitive.attributes.end()) { bytes += asset.accessors[attribute_iter->accessorIndex].count * element_size; }
+        }
+        if(primitive.indicesAccessor.has_value()) { bytes += asset.accessors[primitive.indicesAccessor.value()].count * sizeof(u32); }
+        return bytes;
+    }
+
+    // everything process_mesh reads from the primitive
+    static auto hash_primitive_inputs(fastgltf::Asset& asset, const std::filesystem::path& asset_directory, u32 mesh_index, u32 primitive_index) -> u64 {
+        PROFILE_SCOPE;
+        fastgltf::Primitive& primitive = asset.meshes[mesh_index].primitives[primitive_index];
+
+        ContentHasher hasher = {};
+        hasher.add(MESH_COOK_VERSION);
+        for(std::string_view attribute : { "POSITION", "NORMAL" }) {
+            auto* attribute_iter = primitive.findAttribute(attribute);
+            hasher.add(attribute_iter != primitive.attributes.end());
+            if(attribute_iter != primitive.attributes.end()) { hasher.add(load_data<glm::vec3, false>(asset, asset.accessors[attribute_iter->accessorIndex], asset_directory)); }
+        }
+
+        auto* uvs_attribute_iter = primitive.findAttribute("TEXCOORD_0");
+        hasher.add(uvs_attribute_iter != primitive.attributes.end());
+        if(uvs_attribute_iter != primitive.attributes.end()) { hasher.add(load_data<glm::vec2, false>(asset, asset.accessors[uvs_attribute_iter->accessorIndex], asset_directory)); }
+
+        hasher.add(primitive.indicesAccessor.has_value());
+        if(primitive.indicesAccessor.has_value()) { hasher.add(load_data<u32, true>(asset, asset.accessors[primitive.indicesAccessor.value()], asset_directory)); }
+        return hasher.finish();
+    }
+
+    void AssetConverter::convert_gltf_to_binary(const std::filesystem::path& input_path, const std::filesystem::path& output_path, ThreadPool* thread_pool, const ConverterSettings& settings) {
+        if(!std::filesystem::exists(input_path)) {
+            throw std::runtime_error("couldnt not find model: " + input_path.string());
+        }
+
+        std::filesystem::path const asset_directory = input_path.parent_path();
+        MemoryBudget memory_budget = { .ceiling = settings.memory_budget };
+        // resident memory is process wide, conversions running next to this one show up in it as well
+        auto report_stage_memory = [&](std::string_view stage) {
+            std::optional<u64> const peak_resident_bytes = query_peak_resident_bytes();
+            fmt::println("{} - peak memory: {} MiB resident, {} MiB claimed", stage,
+                peak_resident_bytes.has_value() ? std::to_string(peak_resident_bytes.value() >> 20) : std::string{"n/a"},
+                memory_budget.take_peak() >> 20);
+            reset_peak_resident_bytes();
+        };
+        reset_peak_resident_bytes();
+
+        // glb binary chunks stay views into the mapping, so it has to outlive the asset
+        std::unique_ptr<fastgltf::MappedGltfFile> gltf_file = {};
+        std::unique_ptr<fastgltf::Asset> asset = {};
+        {
+            auto const start_time = std::chrono::steady_clock::now();
+            // dds and ktx2 images are picked over the core image so already compressed blocks can be reused
+            fastgltf::Parser parser{fastgltf::Extensions::MSFT_texture_dds | fastgltf::Extensions::KHR_texture_basisu};
+            // streaming leaves .bin files on disk, accessors and images read just their buffer views through BufferViewReader
+            fastgltf::Options const buffer_options = settings.memory_budget.has_value() ? fastgltf::Options::None : fastgltf::Options::LoadExternalBuffers;
+            fastgltf::Options gltf_options = fastgltf::Options::DontRequireValidAssetMember | fastgltf::Options::AllowDouble | buffer_options;
+
+            auto mapped_file = fastgltf::MappedGltfFile::FromPath(input_path);
+            
+            if(mapped_file.error() != fastgltf::Error::None) {
+                throw std::runtime_error("something went wrong");
+            }
+            gltf_file = std::make_unique<fastgltf::MappedGltfFile>(std::move(mapped_file.get()));
+            
+            auto fastgltf_asset = parser.loadGltf(*gltf_file, asset_directory, gltf_options);
+            asset = std::make_unique<fastgltf::Asset>(std::move(fastgltf_asset.get()));
+
+            f64 const elapsed_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+            fmt::println("parsed {} in {:.1f} ms", input_path.filename().string(), elapsed_ms);
+        }
+        report_stage_memory("parse");
+
+        std::vector<BinaryNode> binary_nodes = {};
+        for(const auto& node : asset->nodes) {
+            std::vector<u32> children = {};
+            for(usize child : node.children) {
+                children.push_back(s_cast<u32>(child));
+            }
+
+            glm::mat4 transform = {};
+
+            if(const auto* trs = std::get_if<fastgltf::TRS>(&node.transform)) {
+                glm::quat quat;
+                quat.x = trs->rotation[0];
+                quat.y = trs->rotation[1];
+                quat.z = trs->rotation[2];
+                quat.w = trs->rotation[3];
+
+                const glm::mat4 scale = glm::scale(glm::identity<glm::mat4x4>(), glm::vec3(trs->scale[0], trs->scale[1], trs->scale[2]));
+                const glm::mat4 rotation = glm::toMat4(glm::quat(trs->rotation[3], trs->rotation[0], trs->rotation[1], trs->rotation[2]));
+                const glm::mat4 translation = glm::translate(glm::identity<glm::mat4x4>(), glm::vec3(trs->translation[0], trs->translation[1], trs->translation[2]));
+                const glm::mat4 rotated_scaled = rotation * scale;
+                const glm::mat4 translated_rotated_scaled = translation * rotated_scaled;
+
+                transform = translated_rotated_scaled;
+            } else if(const auto* transform_matrix = std::get_if<fastgltf::math::fmat4x4>(&node.transform)) {
+                transform = *r_cast<const glm::mat4*>(transform_matrix);
+            }
+
+            binary_nodes.push_back(BinaryNode {
+                .mesh_index = node.meshIndex.has_value() ? std::make_optional(s_cast<u32>(node.meshIndex.value())) : std::nullopt,
+                .transform = transform,
+                .children = children,
+                .name = std::string{node.name.c_str()},
+            });
+        }
+
+        std::vector<BinaryMeshGroup> binary_mesh_groups = {};
+        std::vector<BinaryMesh> binary_meshes = {};
+
+        u32 meshlet_count = {};
+        u32 triangle_count = {};
+        u32 vertex_count = {};
+
+        glm::vec3 model_aabb_max = glm::vec3{std::numeric_limits<f32>::lowest()};
+        glm::vec3 model_aabb_min = glm::vec3{std::numeric_limits<f32>::max()};
+
+        struct ConvertedPrimitive {
+            u32 mesh_index = {};
+            u32 primitive_index = {};
+            std::string file_name = {};
+            u32 meshlet_count = {};
+            u32 triangle_count = {};
+            u32 vertex_count = {};
+            AABB mesh_aabb = {};
+            u64 cache_key = {};
+            bool cache_hit = false;
+            // same geometry as an earlier primitive, shares its cooked file instead of being cooked again
+            std::optional<u32> duplicate_of = std::nullopt;
+        };
+
+        std::filesystem::path const output_directory = output_path.parent_path();
+        std::filesystem::path const store_directory = settings.store_directory.value_or(output_directory);
+        std::filesystem::create_directories(output_directory);
+        std::filesystem::create_directories(store_directory);
+        // binary file paths are relative to the model
+        std::filesystem::path const store_prefix = std::filesystem::relative(store_directory, output_directory);
+        auto store_file_path = [&store_prefix](const std::string& file_name) -> std::string {
+            return (store_prefix / file_name).lexically_normal().generic_string();
+        };
+
+        std::optional<CookCache> own_cook_cache = std::nullopt;
+        if(settings.cook_cache == nullptr) {
+            own_cook_cache = settings.use_cook_cache ? CookCache::load(store_directory) : CookCache { .directory = store_directory };
+        }
+        CookCache& cook_cache = settings.cook_cache != nullptr ? *settings.cook_cache : own_cook_cache.value();
+
+        std::mutex stored_files_mutex = {};
+        ankerl::unordered_dense::set<std::string> stored_files = {};
+        // identical payloads end up with the same name, whoever stores one first writes it and everyone else reuses it
+        auto store_file = [&](const std::vector<std::byte>& data, std::string_view extension) -> std::string {
+            std::string file_name = hash_content(data).to_string() + std::string{extension};
+            {
+                std::lock_guard lock{stored_files_mutex};
+                if(!stored_files.insert(file_name).second) { return file_name; }
+            }
+
+            // existence is all later cooks and the cook cache check, so a file only ever appears complete
+            if(!std::filesystem::exists(store_directory / file_name)) {
+                write_bytes_to_file_atomically(data, store_directory / file_name);
+            }
+            return file_name;
+        };
+
+        std::vector<ConvertedPrimitive> converted_primitives = {};
+        for(u32 mesh_index = 0; mesh_index < asset->meshes.size(); mesh_index++) {
+            const auto& gltf_mesh = asset->meshes.at(mesh_index);
+            binary_mesh_groups.push_back({
+                .mesh_offset = s_cast<u32>(converted_primitives.size()),
+                .mesh_count = s_cast<u32>(gltf_mesh.primitives.size()),
+                .name = gltf_mesh.name.c_str()
+            });
+
+            for(u32 primitive_index = 0; primitive_index < gltf_mesh.primitives.size(); primitive_index++) {
+                converted_primitives.push_back(ConvertedPrimitive {
+                    .mesh_index = mesh_index,
+                    .primitive_index = primitive_index,
+                });
+            }
+        }
+
+        {
+            PROFILE_ZONE_NAMED(processing_primitives);
+            auto const start_time = std::chrono::steady_clock::now();
+
+            u32 const worker_count = std::max(settings.worker_count.value_or(thread_pool->worker_count() + 1), 1u);
+            std::atomic<u32> next_primitive = 0;
+            std::atomic<u32> finished_primitives = 0;
+
+            // the geometry hash doubles as the cook cache key, scenes often reuse the same primitive under several meshes
+            thread_pool->parallel_for(0, converted_primitives.size(), [&](usize primitive) {
+                ConvertedPrimitive& converted = converted_primitives[primitive];
+                // the loaded copy plus the buffer view it was read from
+                MemoryClaim const claim{memory_budget, 2 * primitive_input_bytes(*asset, converted.mesh_index, converted.primitive_index)};
+                converted.cache_key = hash_primitive_inputs(*asset, asset_directory, converted.mesh_index, converted.primitive_index);
+            });
+
+            std::vector<u32> unique_primitives = {};
+            {
+                ankerl::unordered_dense::map<u64, u32> primitive_by_key = {};
+                for(u32 primitive = 0; primitive < converted_primitives.size(); primitive++) {
+                    auto [entry, inserted] = primitive_by_key.try_emplace(converted_primitives[primitive].cache_key, primitive);
+                    if(inserted) { unique_primitives.push_back(primitive); }
+                    else { converted_primitives[primitive].duplicate_of = entry->second; }
+                }
+            }
+
+            // every slot keeps claiming primitives until none are left, large primitives dont hold up a whole batch
+            thread_pool->parallel_for(0, worker_count, [&](usize /*slot_index*/) {
+                for(u32 unique_index = next_primitive.fetch_add(1, std::memory_order_relaxed); unique_index < unique_primitives.size(); unique_index = next_primitive.fetch_add(1, std::memory_order_relaxed)) {
+                    ConvertedPrimitive& converted = converted_primitives[unique_primitives[unique_index]];
+
+                    std::optional<CookedMesh> cooked_mesh = settings.use_cook_cache ? cook_cache.find_mesh(converted.cache_key) : std::nullopt;
+                    if(cooked_mesh.has_value()) {
+                        converted.file_name = cooked_mesh->file_name;
+                        converted.meshlet_count = cooked_mesh->meshlet_count;
+                        converted.triangle_count = cooked_mesh->triangle_count;
+                        converted.vertex_count = cooked_mesh->vertex_count;
+                        converted.mesh_aabb = cooked_mesh->mesh_aabb;
+                        converted.cache_hit = true;
+                    } else {
+                        // held until the .bmesh is written, process_mesh drops the accessor data once its done with it
+                        MemoryClaim const claim{memory_budget, PRIMITIVE_MEMORY_FACTOR * primitive_input_bytes(*asset, converted.mesh_index, converted.primitive_index)};
+                        ProcessedMeshInfo processed_mesh_info = AssetConverter::process_mesh({
+                            .asset = asset.get(),
+                            .gltf_mesh_index = converted.mesh_index,
+                            .gltf_primitive_index = converted.primitive_index,
+                            .thread_pool = thread_pool,
+                            .asset_directory = asset_directory,
+                        });
+
+                        converted.mesh_aabb = processed_mesh_info.mesh_aabb;
+                        converted.meshlet_count = s_cast<u32>(processed_mesh_info.meshlets.size());
+                        converted.vertex_count = s_cast<u32>(processed_mesh_info.positions.size());
+                        for(const auto& meshlet : processed_mesh_info.meshlets) {
+                            converted.triangle_count += meshlet.triangle_count;
+                        }
+
+                        std::vector<std::byte> compressed_data = {};
+                        {
+                            ByteWriter mesh_writer = {};
+                            mesh_writer.write(processed_mesh_info);
+                            processed_mesh_info = {};
+                            compressed_data = zstd_compress(mesh_writer.data, 14);
+                        }
+
+                        converted.file_name = store_file(compressed_data, ".bmesh");
+                    }
+
+                    u32 const finished = finished_primitives.fetch_add(1, std::memory_order_relaxed) + 1;
+                    fmt::println("[{} / {}] - mesh group: {} - mesh: {} - {}", finished, unique_primitives.size(), converted.mesh_index, converted.primitive_index, converted.cache_hit ? "cached" : "done");
+                }
+            });
+
+            for(ConvertedPrimitive& converted : converted_primitives) {
+                if(!converted.duplicate_of.has_value()) { continue; }
+                const ConvertedPrimitive& source = converted_primitives[converted.duplicate_of.value()];
+                converted.file_name = source.file_name;
+                converted.meshlet_count = source.meshlet_count;
+                converted.triangle_count = source.triangle_count;
+                converted.vertex_count = source.vertex_count;
+                converted.mesh_aabb = source.mesh_aabb;
+            }
+
+            f64 const elapsed_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+            fmt::println("processed {} primitives ({} duplicates) on {} workers in {:.1f} ms", converted_primitives.size(), converted_primitives.size() - unique_primitives.size(), worker_count, elapsed_ms);
+        }
+        report_stage_memory("primitives");
+
+        // folded in primitive order so the model header doesnt depend on which worker finished first
+        binary_meshes.reserve(converted_primitives.size());
+        for(const ConvertedPrimitive& converted : converted_primitives) {
+            model_aabb_max = glm::max(model_aabb_max, converted.mesh_aabb.center + converted.mesh_aabb.extent);
+            model_aabb_min = glm::min(model_aabb_max, converted.mesh_aabb.center - converted.mesh_aabb.extent);
+
+            meshlet_count += converted.meshlet_count;
+            triangle_count += converted.triangle_count;
+            vertex_count += converted.vertex_count;
+
+            const auto& primitive = asset->meshes[converted.mesh_index].primitives[converted.primitive_index];
+            std::optional<u32> material_index = std::nullopt;
+            if(primitive.materialIndex.has_value()) {
+                material_index = std::make_optional(s_cast<u32>(primitive.materialIndex.value()));
+            }
+
+            binary_meshes.push_back(BinaryMesh {
+                .material_index = material_index,
+                .meshlet_count = converted.meshlet_count,
+                .file_path = store_file_path(converted.file_name)
+            });
+        }
+
+        struct CustomOutputHandler : public nvtt::OutputHandler {
+            CustomOutputHandler() = default;
+            CustomOutputHandler(const CustomOutputHandler&) = delete;
+            CustomOutputHandler& operator=(const CustomOutputHandler&) = delete;
+            CustomOutputHandler(CustomOutputHandler&&) = delete;
+            CustomOutputHandler& operator=(CustomOutputHandler&&) = delete;
+            virtual ~CustomOutputHandler() {}
+
+            void beginImage(i32 size, i32 /*width*/, i32 /*height*/, i32 /*depth*/, i32 /*face*/, i32 /*miplevel*/) override { data.resize(s_cast<usize>(size)); }
+            auto writeData(const void* ptr, i32 size) -> bool override { std::memcpy(data.data(), ptr, s_cast<usize>(size)); return true; }
+            void endImage() override {}
+
+            std::vector<std::byte> data = {};
+        };
+
+        struct CustomErrorHandler : public nvtt::ErrorHandler {
+            void error(nvtt::Error e) override {
+                fmt::println("{}", std::to_string(e));
+            }
+        };
+
+        std::unique_ptr<CustomErrorHandler> error_handler = std::make_unique<CustomErrorHandler>();
+
+        std::vector<BinaryTexture> binary_textures = {};
+        for (u32 i = 0; i < s_cast<u32>(asset->images.size()); ++i) {
+            binary_textures.push_back(BinaryTexture{
+                .material_indices = {}, 
+                .name = std::string{asset->images[i].name.c_str()},
+                .file_path = {}
+            });
+        }
+
+        auto gltf_texture_to_texture_index = [&](u32 const texture_index) -> std::optional<u32> {
+            const fastgltf::Texture& texture = asset->textures.at(texture_index);
+            if (texture.ddsImageIndex.has_value()) { return s_cast<u32>(texture.ddsImageIndex.value()); }
+            else if (texture.basisuImageIndex.has_value()) { return s_cast<u32>(texture.basisuImageIndex.value()); }
+            else if (texture.imageIndex.has_value()) { return s_cast<u32>(texture.imageIndex.value()); }
+            else { return std::nullopt; }
+        };
+
+        // core image of the texture a dds or ktx2 image came from, converted instead when the compressed one cant be used
+        std::vector<std::optional<u32>> fallback_image_indices(asset->images.size());
+        for(const fastgltf::Texture& texture : asset->textures) {
+            if(!texture.imageIndex.has_value()) { continue; }
+            if(texture.ddsImageIndex.has_value()) { fallback_image_indices[texture.ddsImageIndex.value()] = s_cast<u32>(texture.imageIndex.value()); }
+            if(texture.basisuImageIndex.has_value()) { fallback_image_indices[texture.basisuImageIndex.value()] = s_cast<u32>(texture.imageIndex.value()); }
+        }
+
+        std::vector<BinaryMaterial> binary_materials = {};
+        for(u32 material_index = 0; material_index < s_cast<u32>(asset->materials.size()); material_index++) {
+            const auto& material = asset->materials.at(material_index);
+            u32 const material_manifest_index = material_index;
+            bool const has_normal_texture = material.normalTexture.has_value();
+            bool const has_albedo_texture = material.pbrData.baseColorTexture.has_value();
+            bool const has_roughness_metalness_texture = material.pbrData.metallicRoughnessTexture.has_value();
+            bool const has_emissive_texture = material.emissiveTexture.has_value();
+            std::optional<BinaryMaterial::BinaryTextureInfo> albedo_texture_info = {};
+            std::optional<BinaryMaterial::BinaryTextureInfo> normal_texture_info = {};
+            std::optional<BinaryMaterial::BinaryTextureInfo> roughnes_metalness_info = {};
+            std::optional<BinaryMaterial::BinaryTextureInfo> emissive_info = {};
+            if (has_albedo_texture) {
+                u32 const texture_index = s_cast<u32>(material.pbrData.baseColorTexture.value().textureIndex);
+                auto const has_index = gltf_texture_to_texture_index(texture_index).has_value();
+                if (has_index) {
+                    albedo_texture_info = BinaryMaterial::BinaryTextureInfo {
+                        .texture_index = gltf_texture_to_texture_index(texture_index).value(),
+                        .sampler_index = 0, 
+                    };
+
+                    binary_textures.at(albedo_texture_info->texture_index).material_indices.push_back({
+                        .material_type = MaterialType::GltfAlbedo,
+                        .material_index = material_manifest_index,
+                    });
+                }
+            }
+
+            if (has_normal_texture) {
+                u32 const texture_index = s_cast<u32>(material.normalTexture.value().textureIndex);
+                bool const has_index = gltf_texture_to_texture_index(texture_index).has_value();
+                if (has_index) {
+                    normal_texture_info = BinaryMaterial::BinaryTextureInfo {
+                        .texture_index = gltf_texture_to_texture_index(texture_index).value(),
+                        .sampler_index = 0, 
+                    };
+
+                    binary_textures.at(normal_texture_info->texture_index).material_indices.push_back({
+                        .material_type = MaterialType::GltfNormal,
+                        .material_index = material_manifest_index,
+                    });
+                }
+            }
+
+            if (has_roughness_metalness_texture) {
+                u32 const texture_index = s_cast<u32>(material.pbrData.metallicRoughnessTexture.value().textureIndex);
+                bool const has_index = gltf_texture_to_texture_index(texture_index).has_value();
+                if (has_index) {
+                    roughnes_metalness_info = BinaryMaterial::BinaryTextureInfo {
+                        .texture_index = gltf_texture_to_texture_index(texture_index).value(),
+                        .sampler_index = 0,
+                    };
+
+                    binary_textures.at(roughnes_metalness_info->texture_index).material_indices.push_back({
+                        .material_type = MaterialType::GltfRoughnessMetallic,
+                        .material_index = material_manifest_index,
+                    });
+                }
+            }
+            if (has_emissive_texture) {
+                u32 const texture_index = s_cast<u32>(material.emissiveTexture.value().textureIndex);
+                bool const has_index = gltf_texture_to_texture_index(texture_index).has_value();
+                if (has_index) {
+                    emissive_info = BinaryMaterial::BinaryTextureInfo {
+                        .texture_index = gltf_texture_to_texture_index(texture_index).value(),
+                        .sampler_index = 0,
+                    };
+
+                    binary_textures.at(emissive_info->texture_index).material_indices.push_back({
+                        .material_type = MaterialType::GltfEmissive,
+                        .material_index = material_manifest_index,
+                    });
+                }
+            }
+            
+            binary_materials.push_back(BinaryMaterial{
+                .albedo_info = albedo_texture_info,
+                .normal_info = normal_texture_info,
+                .roughness_metalness_info = roughnes_metalness_info,
+                .emissive_info = emissive_info,
+                .albedo_factor = { material.pbrData.baseColorFactor[0], material.pbrData.baseColorFactor[1], material.pbrData.baseColorFactor[2], material.pbrData.baseColorFactor[3] },
+                .metallic_factor = material.pbrData.metallicFactor,
+                .roughness_factor = material.pbrData.roughnessFactor,
+                .emissive_factor = { material.emissiveFactor[0], material.emissiveFactor[1], material.emissiveFactor[2] },
+                .alpha_mode = s_cast<BinaryAlphaMode>(material.alphaMode),
+                .alpha_cutoff = material.alphaCutoff,
+                .double_sided = material.doubleSided,
+                .name = std::string{material.name.c_str()},
+            });
+        }
+
+        struct ConvertedTexture {
+            u32 image_index = {};
+            std::optional<u32> fallback_image_index = std::nullopt;
+            MaterialType preferred_material_type = MaterialType::None;
+            bool create_alpha_mask = false;
+            f32 average_alpha = {};
+            // the texture itself first, the alpha mask or metalness texture split off from it second
+            std::vector<std::string> file_names = {};
+            std::optional<u32> resolution = std::nullopt;
+            u64 cache_key = {};
+            bool cache_hit = false;
+        };
+
+        std::vector<ConvertedTexture> converted_textures = {};
+
+        // material types are decided up front in image order, compression only fills in the files and resolution
+        for (u32 i = 0; i < s_cast<u32>(asset->images.size()); ++i) {
+            const auto& binary_texture = binary_textures[i];
+            std::vector<MaterialType> cached_material_types = {};
+
+            if (binary_texture.material_indices.empty()) {
+                fmt::println("Warning: Texture {} is not used by any material. Skipping compression.", i);
+                continue; 
+            }
+
+            MaterialType preferred_material_type = MaterialType::None;
+            for(const auto& material_index : binary_texture.material_indices) {
+                bool found = false;
+
+                for(MaterialType cached_material_type : cached_material_types) {
+                    if(material_index.material_type == cached_material_type) {
+                        found = true;
+                    } else if((cached_material_type == MaterialType::GltfAlbedo && material_index.material_type == MaterialType::GltfEmissive) ||
+                              (cached_material_type == MaterialType::GltfEmissive && material_index.material_type == MaterialType::GltfAlbedo)) {
+                        preferred_material_type = MaterialType::GltfAlbedo;
+                    } else {
+                        fmt::println("explode first {} different {}", std::to_string(s_cast<u32>(cached_material_type)), std::to_string(s_cast<u32>(material_index.material_type)));
+                        std::abort();
+                    }
+                }
+
+                if(!found) { cached_material_types.push_back(material_index.material_type); }
+            }
+
+            if(preferred_material_type == MaterialType::None) {
+                if(cached_material_types.size() != 1) {
+                    fmt::println("explode");
+                    std::abort();
+                } else {
+                    preferred_material_type = cached_material_types[0];
+                }
+            }
+
+            bool create_alpha_mask = false;
+            for(const auto& material_index : binary_texture.material_indices) {
+                const auto& material = binary_materials[material_index.material_index];
+                create_alpha_mask |= material.alpha_mode != BinaryAlphaMode::Opaque;
+            }
+
+            f32 average_alpha = 0.0f;
+            if(preferred_material_type == MaterialType::GltfAlbedo && create_alpha_mask) {
+                f32 alpha_sum = 0.0f;
+                u32 alpha_count = 0;
+                for(const auto& material_index : binary_texture.material_indices) {
+                    const BinaryMaterial& binary_material = binary_materials[material_index.material_index];
+                    if(binary_material.alpha_mode == BinaryAlphaMode::Masked) {
+                        alpha_sum += binary_material.alpha_cutoff;
+                        alpha_count += 1;
+                    }
+                }
+
+                average_alpha = alpha_sum / s_cast<f32>(alpha_count);
+            }
+
+            ConvertedTexture converted = {
+                .image_index = i,
+                .fallback_image_index = fallback_image_indices[i],
+                .preferred_material_type = preferred_material_type,
+                .create_alpha_mask = preferred_material_type == MaterialType::GltfAlbedo && create_alpha_mask,
+                .average_alpha = average_alpha,
+            };
+            converted_textures.push_back(std::move(converted));
+        }
+
+        {
+            PROFILE_ZONE_NAMED(compressing_textures);
+            auto const start_time = std::chrono::steady_clock::now();
+
+            u32 const worker_count = std::max(settings.worker_count.value_or(thread_pool->worker_count() + 1), 1u);
+            std::atomic<u32> next_texture = 0;
+            std::atomic<u32> finished_textures = 0;
+            std::mutex texture_errors_mutex = {};
+            std::vector<std::string> texture_errors = {};
+
+            // images compress side by side, decode/mips/bc/zstd of one image overlap with the stages of the others
+            thread_pool->parallel_for(0, worker_count, [&](usize /*slot_index*/) {
+                // nvtt contexts arent safe to share between threads, every slot compresses with its own
+                nvtt::Context context(true);
+                for(u32 texture_index = next_texture.fetch_add(1, std::memory_order_relaxed); texture_index < converted_textures.size(); texture_index = next_texture.fetch_add(1, std::memory_order_relaxed)) {
+                    ConvertedTexture& converted = converted_textures[texture_index];
+
+                    const auto& image = asset->images[converted.image_index];
+
+                    // views memory the asset or the mapped gltf file already own, uri sources get read into file_data and
+                    // buffer views of unloaded external buffers into buffer_views
+                    BufferViewReader buffer_views{ .asset_directory = asset_directory };
+                    auto get_data = [&](const fastgltf::DataSource& data, std::vector<std::byte>& file_data) -> std::span<const std::byte> {
+                        return std::visit(fastgltf::visitor {
+                            [&](const std::monostate&) -> std::span<const std::byte> {
+                                ASSERT(false, "std::monostate should never happen");
+                                return {};
+                            },
+                            [&](const fastgltf::sources::BufferView& source) -> std::span<const std::byte> {
+                                auto const view = buffer_views(*asset, source.bufferViewIndex);
+                                return { view.data(), view.size() };
+                            },
+                            [&](const fastgltf::sources::URI& source) -> std::span<const std::byte> {
+                                std::filesystem::path path{source.uri.path().begin(), source.uri.path().end()};
+                                if(source.uri.isLocalPath()) { path = asset_directory / path; }
+                                file_data = read_file_to_bytes(path);
+                                return file_data;
+                            },
+                            [&](const fastgltf::sources::Array& source) -> std::span<const std::byte> {
+                                return { source.bytes.data(), source.bytes.size_bytes() };
+                            },
+                            [&](const fastgltf::sources::Vector& source) -> std::span<const std::byte> {
+                                return { source.bytes.data(), source.bytes.size() };
+                            },
+                            [&](const fastgltf::sources::CustomBuffer& /* source */) -> std::span<const std::byte> {
+                                ASSERT(false, "fastgltf::sources::CustomBuffer isnt handled");
+                                return {};
+                            },
+                            [&](const fastgltf::sources::ByteView& source) -> std::span<const std::byte> {
+                                return { source.bytes.data(), source.bytes.size() };
+                            },
+                            [&](const fastgltf::sources::Fallback& /* source */) -> std::span<const std::byte> {
+                                ASSERT(false, "fastgltf::sources::Fallback isnt handled");
+                                return {};
+                            },
+                        }, data);
+                    };
+
+                    // the encoded payload is claimed before it gets read, the decode working set joins the claim once the header is known
+                    MemoryClaim claim{memory_budget, image_source_bytes(*asset, asset_directory, image.data)};
+                    std::vector<std::byte> image_file_data = {};
+                    std::span<const std::byte> gltf_data = get_data(image.data, image_file_data);
+
+                    // dds and ktx2 blocks are stored as they are when the format fits, decoded when the texture needs them split,
+                    // and swapped for the core image of the texture when neither works, decided before hashing so the cache key
+                    // covers the bytes that actually get converted
+                    std::optional<CompressedImage> compressed_image = parse_compressed_image(gltf_data);
+                    std::optional<daxa::Format> const stored_format = compressed_image.has_value() ? passthrough_format(compressed_image.value(), converted.preferred_material_type, converted.create_alpha_mask) : std::nullopt;
+                    bool const decodable = compressed_image.has_value() && can_decode_compressed_image(compressed_image.value());
+                    if(is_compressed_image_container(gltf_data) && !stored_format.has_value() && !decodable) {
+                        if(!converted.fallback_image_index.has_value()) {
+                            // thrown once every slot is done, an exception cant leave the pool
+                            std::lock_guard lock{texture_errors_mutex};
+                            texture_errors.push_back(fmt::format("image {} - dds or ktx2 payload isnt supported and the texture has no fallback image", converted.image_index));
+                            continue;
+                        }
+
+                        fmt::println("image {} - dds or ktx2 payload isnt supported, converting image {} instead", converted.image_index, converted.fallback_image_index.value());
+                        const fastgltf::DataSource& fallback_data = asset->images[converted.fallback_image_index.value()].data;
+                        claim.extend(image_source_bytes(*asset, asset_directory, fallback_data));
+                        gltf_data = get_data(fallback_data, image_file_data);
+                        compressed_image = std::nullopt;
+                    }
+
+                    {
+                        ContentHasher hasher = {};
+                        hasher.add(TEXTURE_COOK_VERSION);
+                        hasher.add(converted.preferred_material_type);
+                        hasher.add(converted.create_alpha_mask);
+                        hasher.add(converted.average_alpha);
+                        hasher.add(settings.texture_encoder);
+                        hasher.add_bytes(gltf_data);
+                        converted.cache_key = hasher.finish();
+                    }
+
+                    std::optional<CookedTexture> cooked_texture = settings.use_cook_cache ? cook_cache.find_texture(converted.cache_key) : std::nullopt;
+                    if(cooked_texture.has_value()) {
+                        converted.file_names = cooked_texture->file_names;
+                        converted.resolution = cooked_texture->resolution;
+                        converted.cache_hit = true;
+
+                        u32 const finished = finished_textures.fetch_add(1, std::memory_order_relaxed) + 1;
+                        fmt::println("[{} / {}] - image {} - cached", finished, converted_textures.size(), converted.image_index);
+                        continue;
+                    }
+
+                    auto const texture_start_time = std::chrono::steady_clock::now();
+                    std::vector<std::byte> raw_data = {};
+                    i32 width = 0;
+                    i32 height = 0;
+                    i32 num_channels = 0;
+
+                    // sized from the header before decoding, held until every file of this image is written
+                    if(compressed_image.has_value()) {
+                        width = s_cast<i32>(compressed_image->width);
+                        height = s_cast<i32>(compressed_image->height);
+                    } else {
+                        stbi_info_from_memory(r_cast<const u8*>(gltf_data.data()), s_cast<i32>(gltf_data.size()), &width, &height, &num_channels);
+                    }
+                    // passed through blocks are only copied once more before zstd
+                    claim.extend(stored_format.has_value() ? gltf_data.size() : s_cast<u64>(width) * s_cast<u64>(height) * IMAGE_BYTES_PER_PIXEL);
+
+                    std::optional<BinaryTextureFileFormat> passthrough_texture = std::nullopt;
+                    if(stored_format.has_value()) {
+                        passthrough_texture = BinaryTextureFileFormat {
+                            .width = compressed_image->width,
+                            .height = compressed_image->height,
+                            .depth = 1,
+                            .format = stored_format.value(),
+                            .mipmaps = {}
+                        };
+                        for(std::span<const std::byte> mip : compressed_image->mipmaps) { passthrough_texture->mipmaps.emplace_back(mip.begin(), mip.end()); }
+                    } else if(compressed_image.has_value()) {
+                        raw_data = decode_compressed_image(compressed_image.value());
+                    } else {
+                        u8* image_data = stbi_load_from_memory(r_cast<const u8*>(gltf_data.data()), s_cast<i32>(gltf_data.size()), &width, &height, &num_channels, 4);
+                        if(image_data == nullptr) {
+                            std::lock_guard lock{texture_errors_mutex};
+                            texture_errors.push_back(fmt::format("image {} - couldnt decode image: {}", converted.image_index, stbi_failure_reason()));
+                            continue;
+                        }
+                        raw_data.resize(s_cast<u64>(width) * s_cast<u64>(height) * 4);
+                        std::memcpy(raw_data.data(), image_data, raw_data.size());
+                        stbi_image_free(image_data);
+                    }
+
+                    // the mipmaps of compressed_image view gltf_data
+                    compressed_image = std::nullopt;
+                    gltf_data = {};
+                    image_file_data = {};
+                    buffer_views.read_views.clear();
+
+                    usize const pixel_count = raw_data.size() / 4;
+                    // the encoders below swizzle and split raw_data in place, quality is measured against the decoded image
+                    std::vector<std::byte> const reference_pixels = settings.report_texture_quality ? raw_data : std::vector<std::byte>{};
+
+                    // swizzles the rgba data to bgra in place, optionally forcing alpha to opaque in the same pass
+                    auto create_nvtt_image = [thread_pool, pixel_count](i32 width, i32 height, std::vector<std::byte>& data, bool force_opaque = false) -> nvtt::Surface {
+                        for_each_pixel_chunk(thread_pool, pixel_count, [&](usize first_pixel, usize chunk_pixel_count) {
+                            std::span<std::byte> const pixels = std::span{data}.subspan(first_pixel * 4, chunk_pixel_count * 4);
+                            swizzle_rgba8(pixels, pixels, BGRA_FROM_RGBA);
+                            if(force_opaque) { fill_channel_rgba8(pixels, 3, std::byte{255}); }
+                        });
+
+                        nvtt::Surface nvtt_image;
+                        nvtt_image.setImage(nvtt::InputFormat_BGRA_8UB, width, height, 1, data.data());
+                        return nvtt_image;
+                    };
+
+                    // bc4 only reads red, single channel planes go in as red and the other channels share one zeroed plane
+                    auto create_nvtt_red_image = [](i32 width, i32 height, const std::vector<std::byte>& red, const std::vector<std::byte>& zeros) -> nvtt::Surface {
+                        nvtt::Surface nvtt_image;
+                        nvtt_image.setImage(nvtt::InputFormat_BGRA_8UB, width, height, 1, red.data(), zeros.data(), zeros.data(), zeros.data());
+                        return nvtt_image;
+                    };
+
+                    auto extract_planes = [thread_pool, pixel_count, &raw_data](std::initializer_list<std::pair<u32, std::vector<std::byte>*>> planes) {
+                        for(auto [channel, plane] : planes) { plane->resize(pixel_count); }
+                        for_each_pixel_chunk(thread_pool, pixel_count, [&](usize first_pixel, usize chunk_pixel_count) {
+                            std::span<const std::byte> const pixels = std::span{raw_data}.subspan(first_pixel * 4, chunk_pixel_count * 4);
+                            for(auto [channel, plane] : planes) {
+                                extract_channel_rgba8(pixels, std::span{*plane}.subspan(first_pixel, chunk_pixel_count), channel);
+                            }
+                        });
+                    };
+
+                    struct NVTTSettings {
+                        nvtt::CompressionOptions compression_options = {};
+                        std::unique_ptr<CustomOutputHandler> output_handler = {};
+                        nvtt::OutputOptions output_options = {};
+                    };
+
+                    auto create_nvtt_settings = [&error_handler](NVTTSettings& nvtt_settings, nvtt::Format nvtt_format) {
+                        nvtt_settings.compression_options.setFormat(nvtt_format);
+                        nvtt_settings.compression_options.setQuality(nvtt::Quality_Normal);
+                        nvtt_settings.output_handler = std::make_unique<CustomOutputHandler>();
+                        nvtt_settings.output_options.setOutputHandler(nvtt_settings.output_handler.get());
+                        nvtt_settings.output_options.setErrorHandler(error_handler.get());
+                    };
+
+                    // reference_channels are the channels of the decoded image the format stores, in the order it stores them
+                    auto write_texture_file = [&](const BinaryTextureFileFormat& texture, std::initializer_list<u32> reference_channels) {
+                        if(settings.report_texture_quality) {
+                            std::optional<f64> const psnr = measure_top_mip_psnr(texture, reference_pixels, std::span{reference_channels.begin(), reference_channels.size()});
+                            if(psnr.has_value()) { fmt::println("image {} - file {} - psnr {:.2f} dB", converted.image_index, converted.file_names.size(), psnr.value()); }
+                        }
+
+                        std::vector<std::byte> compressed_data = {};
+                        {
+                            ByteWriter image_writer = {};
+                            image_writer.write(texture);
+                            compressed_data = zstd_compress(image_writer.data, 14);
+                        }
+
+                        converted.file_names.push_back(store_file(compressed_data, ".btexture"));
+                    };
+
+                    const MaterialType preferred_material_type = converted.preferred_material_type;
+                    // bc7 has no native encoder, those textures stay on nvtt either way
+                    bool const native_encoder = settings.texture_encoder == TextureEncoder::Native && (
+                        preferred_material_type == MaterialType::GltfAlbedo ||
+                        preferred_material_type == MaterialType::GltfNormal ||
+                        preferred_material_type == MaterialType::GltfEmissive ||
+                        preferred_material_type == MaterialType::GltfRoughnessMetallic
+                    );
+
+                    if(passthrough_texture.has_value()) {
+                        write_texture_file(passthrough_texture.value(), {});
+                        converted.resolution = s_cast<u32>(width);
+                    } else if(native_encoder) {
+                        u32 const texture_width = s_cast<u32>(width);
+                        u32 const texture_height = s_cast<u32>(height);
+
+                        // consumes the rgba level, mips are box filtered in linear space
+                        auto encode_native_srgb_bc1 = [&](std::vector<std::byte> level) -> BinaryTextureFileFormat {
+                            return encode_native_mip_chain(texture_width, texture_height, daxa::Format::BC1_RGB_SRGB_BLOCK,
+                                [&](u32 level_width, u32 level_height) { return encode_bc1(level, level_width, level_height, thread_pool); },
+                                [&](u32 level_width, u32 level_height) { level = downsample_rgba8(level, level_width, level_height, true, thread_pool); });
+                        };
+
+                        auto encode_native_bc4 = [&](std::vector<std::byte> plane) -> BinaryTextureFileFormat {
+                            return encode_native_mip_chain(texture_width, texture_height, daxa::Format::BC4_UNORM_BLOCK,
+                                [&](u32 level_width, u32 level_height) { return encode_bc4(plane, level_width, level_height, thread_pool); },
+                                [&](u32 level_width, u32 level_height) { plane = downsample_plane(plane, level_width, level_height, thread_pool); });
+                        };
+
+                        if(preferred_material_type == MaterialType::GltfAlbedo) {
+                            std::vector<std::byte> alpha_plane = {};
+                            if(converted.create_alpha_mask) { extract_planes({ { 3, &alpha_plane } }); }
+
+                            // bc1 ignores alpha so the albedo doesnt need to be made opaque
+                            write_texture_file(encode_native_srgb_bc1(std::move(raw_data)), { 0, 1, 2 });
+                            converted.resolution = texture_width;
+
+                            if(converted.create_alpha_mask) {
+                                const f32 average_alpha = converted.average_alpha;
+                                const f32 coverage = alpha_coverage(alpha_plane, average_alpha);
+                                BinaryTextureFileFormat const texture = encode_native_mip_chain(texture_width, texture_height, daxa::Format::BC4_UNORM_BLOCK,
+                                    [&](u32 level_width, u32 level_height) { return encode_bc4(alpha_plane, level_width, level_height, thread_pool); },
+                                    [&](u32 level_width, u32 level_height) {
+                                        alpha_plane = downsample_plane(alpha_plane, level_width, level_height, thread_pool);
+                                        scale_alpha_to_coverage(alpha_plane, coverage, average_alpha, thread_pool);
+                                    });
+                                write_texture_file(texture, { 3 });
+                            }
+                        } else if(preferred_material_type == MaterialType::GltfNormal) {
+                            normalize_normal_map(raw_data, thread_pool);
+                            BinaryTextureFileFormat const texture = encode_native_mip_chain(texture_width, texture_height, daxa::Format::BC5_UNORM_BLOCK,
+                                [&](u32 level_width, u32 level_height) { return encode_bc5(raw_data, level_width, level_height, thread_pool); },
+                                [&](u32 level_width, u32 level_height) {
+                                    raw_data = downsample_rgba8(raw_data, level_width, level_height, false, thread_pool);
+                                    normalize_normal_map(raw_data, thread_pool);
+                                });
+                            write_texture_file(texture, { 0, 1 });
+                            converted.resolution = texture_width;
+                        } else if(preferred_material_type == MaterialType::GltfEmissive) {
+                            write_texture_file(encode_native_srgb_bc1(std::move(raw_data)), { 0, 1, 2 });
+                            converted.resolution = texture_width;
+                        } else {
+                            // gltf keeps roughness in green and metalness in blue
+                            std::vector<std::byte> roughness = {};
+                            std::vector<std::byte> metalness = {};
+                            extract_planes({ { 1, &roughness }, { 2, &metalness } });
+                            write_texture_file(encode_native_bc4(std::move(roughness)), { 1 });
+                            write_texture_file(encode_native_bc4(std::move(metalness)), { 2 });
+                            converted.resolution = texture_width;
+                        }
+                    } else if(preferred_material_type == MaterialType::GltfAlbedo) {
+                        // the mask is split off first, the albedo then gets swizzled and made opaque in place
+                        std::vector<std::byte> alpha_plane = {};
+                        if(converted.create_alpha_mask) { extract_planes({ { 3, &alpha_plane } }); }
+
+                        {
+                            nvtt::Surface nvtt_image = create_nvtt_image(width, height, raw_data, true);
+                            nvtt::Format compressed_format = nvtt::Format_BC1;
+                            daxa::Format daxa_format = daxa::Format::BC1_RGB_SRGB_BLOCK;
+
+                            NVTTSettings nvtt_settings = {};
+                            create_nvtt_settings(nvtt_settings, compressed_format);
+
+                            BinaryTextureFileFormat texture {
+                                .width = s_cast<u32>(width),
+                                .height = s_cast<u32>(height),
+                                .depth = 1,
+                                .format = daxa_format,
+                                .mipmaps = {}
+                            };
+
+                            const i32 num_mipmaps = nvtt_image.countMipmaps();
+                            for(i32 mip = 0; mip < num_mipmaps; mip++) {
+                                context.compress(nvtt_image, 0, mip, nvtt_settings.compression_options, nvtt_settings.output_options);
+                                texture.mipmaps.push_back(nvtt_settings.output_handler->data);
+
+                                if(mip == num_mipmaps - 1) { break; }
+
+                                nvtt_image.toLinearFromSrgb();
+                                nvtt_image.buildNextMipmap(nvtt::MipmapFilter_Box);
+                                nvtt_image.toSrgb();
+                            }
+
+                            write_texture_file(texture, { 0, 1, 2 });
+                            converted.resolution = s_cast<u32>(width);
+                        }
+
+                        if(converted.create_alpha_mask) {
+                            const f32 average_alpha = converted.average_alpha;
+                            std::vector<std::byte> const zero_plane(pixel_count);
+                            nvtt::Surface nvtt_image = create_nvtt_red_image(width, height, alpha_plane, zero_plane);
+                            nvtt::Format compressed_format = nvtt::Format_BC4;
+                            daxa::Format daxa_format = daxa::Format::BC4_UNORM_BLOCK;
+
+                            NVTTSettings nvtt_settings = {};
+                            create_nvtt_settings(nvtt_settings, compressed_format);
+
+                            BinaryTextureFileFormat texture {
+                                .width = s_cast<u32>(width),
+                                .height = s_cast<u32>(height),
+                                .depth = 1,
+                                .format = daxa_format,
+                                .mipmaps = {}
+                            };
+
+                            const i32 num_mipmaps = nvtt_image.countMipmaps();
+                            const f32 coverage = nvtt_image.alphaTestCoverage(average_alpha, 0);
+                            for(i32 mip = 0; mip < num_mipmaps; mip++) {
+                                context.compress(nvtt_image, 0, mip, nvtt_settings.compression_options, nvtt_settings.output_options);
+                                texture.mipmaps.push_back(nvtt_settings.output_handler->data);
+
+                                if(mip == num_mipmaps - 1) { break; }
+
+                                nvtt_image.scaleAlphaToCoverage(coverage, average_alpha);
+                                nvtt_image.buildNextMipmap(nvtt::MipmapFilter_Kaiser);
+                            }
+
+                            write_texture_file(texture, { 3 });
+                        }
+                    } else if(preferred_material_type == MaterialType::GltfNormal) {
+                        nvtt::Surface nvtt_image = create_nvtt_image(width, height, raw_data);
+                        nvtt::Format compressed_format = nvtt::Format_BC5;
+                        daxa::Format daxa_format = daxa::Format::BC5_UNORM_BLOCK;
+
+                        NVTTSettings nvtt_settings = {};
+                        create_nvtt_settings(nvtt_settings, compressed_format);
+
+                        BinaryTextureFileFormat texture {
+                            .width = s_cast<u32>(width),
+                            .height = s_cast<u32>(height),
+                            .depth = 1,
+                            .format = daxa_format,
+                            .mipmaps = {}
+                        };
+
+                        const i32 num_mipmaps = nvtt_image.countMipmaps();
+                        for(i32 mip = 0; mip < num_mipmaps; mip++) {
+                            nvtt_image.normalizeNormalMap();
+                            nvtt::Surface temp = nvtt_image;
+                            temp.transformNormals(nvtt::NormalTransform_Orthographic);
+                            context.compress(temp, 0, mip, nvtt_settings.compression_options, nvtt_settings.output_options);
+                            texture.mipmaps.push_back(nvtt_settings.output_handler->data);
+
+                            if(mip == num_mipmaps - 1) { break; }
+
+                            nvtt_image.buildNextMipmap(nvtt::MipmapFilter_Box);
+                        }
+
+                        write_texture_file(texture, { 0, 1 });
+                        converted.resolution = s_cast<u32>(width);
+                    } else if(preferred_material_type == MaterialType::GltfEmissive) {
+                        nvtt::Surface nvtt_image = create_nvtt_image(width, height, raw_data);
+                        nvtt::Format compressed_format = nvtt::Format_BC1;
+                        daxa::Format daxa_format = daxa::Format::BC1_RGB_SRGB_BLOCK;
+
+                        NVTTSettings nvtt_settings = {};
+                        create_nvtt_settings(nvtt_settings, compressed_format);
+
+                        BinaryTextureFileFormat texture {
+                            .width = s_cast<u32>(width),
+                            .height = s_cast<u32>(height),
+                            .depth = 1,
+                            .format = daxa_format,
+                            .mipmaps = {}
+                        };
+
+                        const i32 num_mipmaps = nvtt_image.countMipmaps();
+                        for(i32 mip = 0; mip < num_mipmaps; mip++) {
+                            context.compress(nvtt_image, 0, mip, nvtt_settings.compression_options, nvtt_settings.output_options);
+                            texture.mipmaps.push_back(nvtt_settings.output_handler->data);
+
+                            if(mip == num_mipmaps - 1) { break; }
+
+                            nvtt_image.toLinearFromSrgb();
+                            nvtt_image.buildNextMipmap(nvtt::MipmapFilter_Box);
+                            nvtt_image.toSrgb();
+                        }
+
+                        write_texture_file(texture, { 0, 1, 2 });
+                        converted.resolution = s_cast<u32>(width);
+                    } else if(preferred_material_type == MaterialType::GltfRoughnessMetallic) {
+                        // gltf keeps roughness in green and metalness in blue
+                        std::vector<std::byte> roughness = {};
+                        std::vector<std::byte> metalness = {};
+                        extract_planes({ { 1, &roughness }, { 2, &metalness } });
+
+                        std::vector<std::byte> const zero_plane(pixel_count);
+                        nvtt::Surface nvtt_roughness_image = create_nvtt_red_image(width, height, roughness, zero_plane);
+                        nvtt::Surface nvtt_metalness_image = create_nvtt_red_image(width, height, metalness, zero_plane);
+                        nvtt::Format compressed_format = nvtt::Format_BC4;
+                        daxa::Format daxa_format = daxa::Format::BC4_UNORM_BLOCK;
+
+                        NVTTSettings nvtt_settings = {};
+                        create_nvtt_settings(nvtt_settings, compressed_format);
+
+                        BinaryTextureFileFormat roughness_texture {
+                            .width = s_cast<u32>(width),
+                            .height = s_cast<u32>(height),
+                            .depth = 1,
+                            .format = daxa_format,
+                            .mipmaps = {}
+                        };
+
+                        BinaryTextureFileFormat metalness_texture {
+                            .width = s_cast<u32>(width),
+                            .height = s_cast<u32>(height),
+                            .depth = 1,
+                            .format = daxa_format,
+                            .mipmaps = {}
+                        };
+
+                        const i32 num_mipmaps = nvtt_roughness_image.countMipmaps();
+                        for(i32 mip = 0; mip < num_mipmaps; mip++) {
+                            context.compress(nvtt_roughness_image, 0, mip, nvtt_settings.compression_options, nvtt_settings.output_options);
+                            roughness_texture.mipmaps.push_back(nvtt_settings.output_handler->data);
+                            context.compress(nvtt_metalness_image, 0, mip, nvtt_settings.compression_options, nvtt_settings.output_options);
+                            metalness_texture.mipmaps.push_back(nvtt_settings.output_handler->data);
+
+                            if(mip == num_mipmaps - 1) { break; }
+
+                            nvtt_roughness_image.buildNextMipmap(nvtt::MipmapFilter_Box);
+                            nvtt_metalness_image.buildNextMipmap(nvtt::MipmapFilter_Box);
+                        }
+
+                        write_texture_file(roughness_texture, { 1 });
+                        write_texture_file(metalness_texture, { 2 });
+                        converted.resolution = s_cast<u32>(width);
+                    } else {
+                        nvtt::Surface nvtt_image = create_nvtt_image(width, height, raw_data);
+                        nvtt::Format compressed_format = nvtt::Format_BC7;
+                        daxa::Format daxa_format = (preferred_material_type == MaterialType::GltfAlbedo || preferred_material_type == MaterialType::GltfEmissive) ? daxa::Format::BC7_SRGB_BLOCK : daxa::Format::BC7_UNORM_BLOCK;
+
+                        NVTTSettings nvtt_settings = {};
+                        create_nvtt_settings(nvtt_settings, compressed_format);
+
+                        BinaryTextureFileFormat texture {
+                            .width = s_cast<u32>(width),
+                            .height = s_cast<u32>(height),
+                            .depth = 1,
+                            .format = daxa_format,
+                            .mipmaps = {}
+                        };
+
+                        const i32 num_mipmaps = nvtt_image.countMipmaps();
+                        for(i32 mip = 0; mip < num_mipmaps; mip++) {
+                            context.compress(nvtt_image, 0, mip, nvtt_settings.compression_options, nvtt_settings.output_options);
+                            texture.mipmaps.push_back(nvtt_settings.output_handler->data);
+
+                            if(mip == num_mipmaps - 1) { break; }
+
+                            nvtt_image.toLinearFromSrgb();
+                            nvtt_image.premultiplyAlpha();
+                            nvtt_image.buildNextMipmap(nvtt::MipmapFilter_Box);
+                            nvtt_image.demultiplyAlpha();
+                            nvtt_image.toSrgb();
+                        }
+
+                        write_texture_file(texture, {});
+                    }
+
+                    u32 const finished = finished_textures.fetch_add(1, std::memory_order_relaxed) + 1;
+                    std::string_view const outcome = passthrough_texture.has_value() ? "passed through" : "done";
+                    if(settings.report_texture_quality) {
+                        f64 const texture_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - texture_start_time).count();
+                        f64 const megapixels_per_second = s_cast<f64>(width) * s_cast<f64>(height) / (texture_ms * 1000.0);
+                        fmt::println("[{} / {}] - image {} - {} in {:.1f} ms ({:.1f} Mpix/s)", finished, converted_textures.size(), converted.image_index, outcome, texture_ms, megapixels_per_second);
+                    } else {
+                        fmt::println("[{} / {}] - image {} - {}", finished, converted_textures.size(), converted.image_index, outcome);
+                    }
+                }
+            });
+
+            if(!texture_errors.empty()) { throw std::runtime_error(texture_errors.front()); }
+
+            f64 const elapsed_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - start_time).count();
+            fmt::println("compressed {} images on {} workers in {:.1f} ms", converted_textures.size(), worker_count, elapsed_ms);
+        }
+        report_stage_memory("textures");
+
+        // split off textures are appended in image order so texture indices dont depend on which worker finished first
+        for(const ConvertedTexture& converted : converted_textures) {
+            u32 const i = converted.image_index;
+            binary_textures[i].file_path = store_file_path(converted.file_names[0]);
+            if(converted.resolution.has_value()) { binary_textures[i].resolution = converted.resolution.value(); }
+
+            if(converted.create_alpha_mask) {
+                const BinaryTexture& albedo_texture = binary_textures[i];
+                u32 alpha_mask_texture_index = s_cast<u32>(binary_textures.size());
+                BinaryTexture alpha_mask_texture = BinaryTexture {
+                    .resolution = converted.resolution.value(),
+                    .material_indices = {},
+                    .name = {},
+                    .file_path = store_file_path(converted.file_names[1]),
+                };
+
+                for(const auto& material_index : albedo_texture.material_indices) {
+                    auto& material = binary_materials[material_index.material_index];
+
+                    if(material.alpha_mode != BinaryAlphaMode::Opaque) {
+                        material.alpha_mask_info = BinaryMaterial::BinaryTextureInfo {
+                            .texture_index = alpha_mask_texture_index,
+                            .sampler_index = 0
+                        };
+
+                        alpha_mask_texture.material_indices.push_back(BinaryTexture::BinaryMaterialIndex{
+                            .material_type = MaterialType::CompressedAlphaMask,
+                            .material_index = material_index.material_index
+                        });
+                    }
+                }
+
+                binary_textures.push_back(alpha_mask_texture);
+            } else if(converted.preferred_material_type == MaterialType::GltfRoughnessMetallic) {
+                // convert to roughness
+                BinaryTexture& roughness_metallic_texture = binary_textures[i];
+                u32 metalness_texture_index = s_cast<u32>(binary_textures.size());
+                BinaryTexture binary_metalness_texture = BinaryTexture {
+                    .resolution = converted.resolution.value(),
+                    .material_indices = {},
+                    .name = {},
+                    .file_path = store_file_path(converted.file_names[1]),
+                };
+
+                for(auto& material_index : roughness_metallic_texture.material_indices) {
+                    material_index.material_type = MaterialType::CompressedRoughness;
+                    binary_metalness_texture.material_indices.push_back(BinaryTexture::BinaryMaterialIndex {
+                        .material_type = MaterialType::CompressedMetalness,
+                        .material_index = material_index.material_index
+                    });
+
+                    BinaryMaterial& binary_material = binary_materials[material_index.material_index];
+                    binary_material.roughness_info = BinaryMaterial::BinaryTextureInfo {
+                        .texture_index = binary_material.roughness_metalness_info->texture_index,
+                        .sampler_index = 0
+                    };
+                    binary_material.metalness_info = BinaryMaterial::BinaryTextureInfo {
+                        .texture_index = metalness_texture_index,
+                        .sampler_index = 0
+                    };
+
+                    binary_material.roughness_metalness_info = std::nullopt;
+                }
+
+                binary_textures.push_back(binary_metalness_texture);
+            }
+        }
+
+        {
+            u32 mesh_cache_hits = 0;
+            u32 mesh_cache_misses = 0;
+            for(const ConvertedPrimitive& converted : converted_primitives) {
+                if(converted.duplicate_of.has_value()) { continue; }
+                if(converted.cache_hit) { mesh_cache_hits++; continue; }
+                mesh_cache_misses++;
+                cook_cache.insert_mesh(CookedMesh {
+                    .key = converted.cache_key,
+                    .file_name = converted.file_name,
+                    .meshlet_count = converted.meshlet_count,
+                    .triangle_count = converted.triangle_count,
+                    .vertex_count = converted.vertex_count,
+                    .mesh_aabb = converted.mesh_aabb,
+                });
+            }
+
+            u32 texture_cache_hits = 0;
+            for(const ConvertedTexture& converted : converted_textures) {
+                if(converted.cache_hit) { texture_cache_hits++; continue; }
+                cook_cache.insert_texture(CookedTexture {
+                    .key = converted.cache_key,
+                    .file_names = converted.file_names,
+                    .resolution = converted.resolution,
+                });
+            }
+
+            if(settings.use_cook_cache && own_cook_cache.has_value()) { cook_cache.save(); }
+            fmt::println("cook cache - meshes: {} hits {} misses - textures: {} hits {} misses",
+                mesh_cache_hits, mesh_cache_misses, texture_cache_hits, converted_textures.size() - texture_cache_hits);
+        }
+
+        auto const write_start_time = std::chrono::steady_clock::now();
+        std::vector<std::byte> compressed_data = {};
+        {
+            ByteWriter byte_writer;
+            byte_writer.write(BinaryModelHeader {
+                .name = "binary model",
+                .version = 0,
+                .meshlet_count = meshlet_count,
+                .triangle_count = triangle_count,
+                .vertex_count = vertex_count,
+                .model_aabb = {
+                    .center = (model_aabb_min + model_aabb_max) * 0.5f,
+                    .extent = (model_aabb_max - model_aabb_min) * 0.5f,
+                }
+            });
+
+            byte_writer.write(BinaryAssetInfo {
+                .nodes = binary_nodes,
+                .mesh_groups = binary_mesh_groups,
+                .meshes = binary_meshes,
+                .materials = binary_materials,
+                .textures = binary_textures,
+            });
+
+            fmt::println("writer {}", byte_writer.data.size());
+            compressed_data = zstd_compress(byte_writer.data, 14);
+        }
+    
+        write_bytes_to_file(compressed_data, output_path);
+        f64 const write_elapsed_ms = std::chrono::duration<f64, std::milli>(std::chrono::steady_clock::now() - write_start_time).count();
+        fmt::println("wrote {} in {:.1f} ms", output_path.filename().string(), write_elapsed_ms);
+        report_stage_memory("write");
+    }
+
+#pragma region FIND CONNECTED MESHLETS
+    // meshlet graph in the compressed sparse row layout METIS_PartGraphKway takes, vertices are simplification queue indices
+    struct MeshletAdjacency {
+        std::pmr::vector<i32> xadj = {};
+        std::pmr::vector<i32> adjncy = {};
+        // vertices shared by the two meshlets of an edge
+        std::pmr::vector<i32> adjwgt = {};
+    };
+
+    struct FindConnectedMeshletsInfo {
+        const std::vector<u32>& simplification_queue;
+        const std::vector<Meshlet>& meshlets;
+        const std::vector<u32>& meshlet_indirect_vertices;
+        const std::vector<u8>& meshlet_micro_indices;
+        const std::vector<glm::vec3>& positions;
+        std::pmr::memory_resource* arena = std::pmr::get_default_resource();
+    };
+
+    static auto find_connected_meshlets(const FindConnectedMeshletsInfo& info) -> MeshletAdjacency {
+        u32 const queue_size = s_cast<u32>(info.simplification_queue.size());
+
+        // vertex -> meshlets csr, counted first and filled second, last_meshlet skips vertices repeated within a meshlet
+        std::pmr::vector<u32> vertex_offsets(info.positions.size() + 1, 0, info.arena);
+        std::pmr::vector<u32> last_meshlet(info.positions.size(), std::numeric_limits<u32>::max(), info.arena);
+        for(u32 meshlet_queue_index = 0; meshlet_queue_index < queue_size; meshlet_queue_index++) {
+            const Meshlet& meshlet = info.meshlets[info.simplification_queue[meshlet_queue_index]];
+            for(u32 i = 0; i < meshlet.vertex_count; i++) {
+                u32 const vertex_index = info.meshlet_indirect_vertices[meshlet.indirect_vertex_offset + i];
+                if(last_meshlet[vertex_index] == meshlet_queue_index) { continue; }
+                last_meshlet[vertex_index] = meshlet_queue_index;
+                vertex_offsets[vertex_index + 1]++;
+            }
+        }
+        std::inclusive_scan(vertex_offsets.begin(), vertex_offsets.end(), vertex_offsets.begin());
+
+        std::pmr::vector<u32> vertex_meshlets(vertex_offsets.back(), info.arena);
+        std::pmr::vector<u32> vertex_fill(vertex_offsets, info.arena);
+        std::ranges::fill(last_meshlet, std::numeric_limits<u32>::max());
+        for(u32 meshlet_queue_index = 0; meshlet_queue_index < queue_size; meshlet_queue_index++) {
+            const Meshlet& meshlet = info.meshlets[info.simplification_queue[meshlet_queue_index]];
+            for(u32 i = 0; i < meshlet.vertex_count; i++) {
+                u32 const vertex_index = info.meshlet_indirect_vertices[meshlet.indirect_vertex_offset + i];
+                if(last_meshlet[vertex_index] == meshlet_queue_index) { continue; }
+                last_meshlet[vertex_index] = meshlet_queue_index;
+                vertex_meshlets[vertex_fill[vertex_index]++] = meshlet_queue_index;
+            }
+        }
+
+        // every meshlet pair sharing a vertex becomes two directed edge keys, after sorting a run of equal keys is one weighted edge
+        std::pmr::vector<u64> edge_keys(info.arena);
+        for(usize vertex_index = 0; vertex_index < info.positions.size(); vertex_index++) {
+            u32 const first = vertex_offsets[vertex_index];
+            u32 const last = vertex_offsets[vertex_index + 1];
+            for(u32 i = first; i < last; i++) {
+                for(u32 j = i + 1; j < last; j++) {
+                    edge_keys.push_back((s_cast<u64>(vertex_meshlets[i]) << 32) | vertex_meshlets[j]);
+                    edge_keys.push_back((s_cast<u64>(vertex_meshlets[j]) << 32) | vertex_meshlets[i]);
+                }
+            }
+        }
+        std::ranges::sort(edge_keys);
+
+        MeshletAdjacency adjacency = {
+            .xadj = std::pmr::vector<i32>(queue_size + 1, 0, info.arena),
+            .adjncy = std::pmr::vector<i32>(info.arena),
+            .adjwgt = std::pmr::vector<i32>(info.arena),
+        };
+        for(usize i = 0; i < edge_keys.size();) {
+            usize run_end = i + 1;
+            while(run_end < edge_keys.size() && edge_keys[run_end] == edge_keys[i]) { run_end++; }
+
+            adjacency.xadj[s_cast<usize>(edge_keys[i] >> 32) + 1]++;
+            adjacency.adjncy.push_back(s_cast<i32>(edge_keys[i] & 0xffffffff));
+            adjacency.adjwgt.push_back(s_cast<i32>(run_end - i));
+            i = run_end;
+        }
+        std::inclusive_scan(adjacency.xadj.begin(), adjacency.xadj.end(), adjacency.xadj.begin());
+
+        return adjacency;
+    }
+#pragma endregion
+
+#pragma region GROUP MESHLETS
+    struct GroupMeshletsInfo {
+        MeshletAdjacency& adjacency;
+        const std::vector<u32>& simplification_queue = {};
+        std::pmr::memory_resource* arena = std::pmr::get_default_resource();
+    };
+
+    static auto group_meshlets(const GroupMeshletsInfo& info) -> std::vector<std::vector<u32>> {
+        std::array<idx_t, METIS_NOPTIONS> options = {};
+        METIS_SetDefaultOptions(options.data());
+        options[METIS_OPTION_SEED] = 17;
+
+        i32 ncon = 1;
+        i32 partition_count = s_cast<i32>(round_up_div(s_cast<u32>(info.simplification_queue.size()), s_cast<u32>(TARGET_MESHLETS_PER_GROUP)));
+        i32 nvtxs = s_cast<i32>(info.adjacency.xadj.size()) - 1;
+        i32 edgecut = 0;
+
+        // special case for METIS
+        if(partition_count == 1) {
+            return { info.simplification_queue };
+        }
+
+        std::pmr::vector<i32> group_per_meshlet(info.simplification_queue.size(), info.arena);
+
+        METIS_PartGraphKway(&nvtxs, 
+            &ncon, 
+            info.adjacency.xadj.data(), 
+            info.adjacency.adjncy.data(), 
+            nullptr, 
+            nullptr, 
+            info.adjacency.adjwgt.data(), 
+            &partition_count, 
+            nullptr, 
+            nullptr, 
+            options.data(), 
+            &edgecut, 
+            group_per_meshlet.data());
+
+
+        std::vector<std::vector<u32>> groups = {};
+        groups.resize(s_cast<usize>(partition_count));
+
+        u32 meshlet_queue_id = 0;
+        for(const i32 meshlet_group : group_per_meshlet) {
+            groups[s_cast<usize>(meshlet_group)].push_back(info.simplification_queue[meshlet_queue_id]);
+            meshlet_queue_id++;
+        }
+        
+        return groups;
+    };
+#pragma endregion
+
+#pragma region LOCK BORDERS
+    struct LockGroupBordersInfo {
+        std::vector<u8>& vertex_locks;
+        const std::vector<std::vector<u32>>& groups;
+        const std::vector<Meshlet>& meshlets;
+        const std::vector<u32>& meshlet_indirect_vertices;
+        const std::vector<glm::vec3>& positions;
+        std::pmr::memory_resource* arena = std::pmr::get_default_resource();
+    };
+
+    static void lock_group_borders(const LockGroupBordersInfo& info) {
+        std::pmr::vector<i32> locks(info.positions.size(), -1, info.arena);
+
+        u32 group_id = 0;
+        for(const std::vector<u32>& meshlets : info.groups) {
+            for(u32 meshlet_id = 0; meshlet_id < meshlets.size(); meshlet_id++) {
+                const Meshlet& meshlet = info.meshlets[meshlet_id];
+
+                for (u32 i = 0; i < meshlet.vertex_count; ++i) {
+                    u32 vertex_id = info.meshlet_indirect_vertices[meshlet.indirect_vertex_offset + i];
+                    if(locks[vertex_id] == -1 || locks[vertex_id] == s_cast<i32>(group_id)) {
+                        locks[vertex_id] = s_cast<i32>(group_id);
+                    } else {
+                        locks[vertex_id] = -2;
+                    }
+                }
+            }
+
+            group_id++;
+        }
+
+        for(u32 i = 0; i < info.positions.size(); i++) {
+            info.vertex_locks[i] = s_cast<u8>(locks[i] == -2);
+        }
+    };
+#pragma endregion
+
+#pragma region SIMPLIFY MESHLET GROUP
+    struct SimplifyMeshletGroupInfo {
+        const std::vector<u32>& group_meshlets;
+        const std::vector<Meshlet>& meshlets;
+        const std::vector<u32>& meshlet_indirect_vertices;
+        const std::vector<u8>& meshlet_micro_indices;
+        const std::vector<glm::vec3>& positions;
+        const std::vector<glm::vec3>& normals;
+        const std::vector<u8>& vertex_locks;
+        std::pmr::memory_resource* arena = std::pmr::get_default_resource();
+    };
+
+    static auto simplify_meshlet_group(const SimplifyMeshletGroupInfo& info) -> std::optional<std::pair<std::pmr::vector<u32>, f32>> {
+        std::pmr::vector<u32> group_indices(info.arena);
+
+        for(const u32 meshlet_id : info.group_meshlets) {
+            const Meshlet& meshlet = info.meshlets[meshlet_id];
+
+            for(u32 triangle_index = 0; triangle_index < meshlet.triangle_count; triangle_index++) {
+                for(u32 triangle_corner_index = 0; triangle_corner_index < 3; triangle_corner_index++) {
+                    u32 micro_index = info.meshlet_micro_indices[meshlet.micro_indices_offset + triangle_index * 3 + triangle_corner_index];
+                    group_indices.push_back(info.meshlet_indirect_vertices[meshlet.indirect_vertex_offset + micro_index]);
+
+                }
+            }
+        }
+
+        std::array<f32, 3> attribute_weights = { 0.5f, 0.5f, 0.5f };
+
+        f32 error = 0.0f;
+        std::pmr::vector<u32> simplified_group_indices(group_indices.size(), info.arena);
+        usize index_count = meshopt_simplifyWithAttributes(
+            simplified_group_indices.data(), 
+            group_indices.data(), 
+            group_indices.size(), 
+            r_cast<const f32*>(info.positions.data()), 
+            info.positions.size(), 
+            sizeof(glm::vec3),
+            r_cast<const f32*>(info.normals.data()),
+            sizeof(glm::vec3),
+            attribute_weights.data(),
+            attribute_weights.size(),
+            info.vertex_locks.data(), 
+            group_indices.size() / 2, 
+            std::numeric_limits<f32>::max(), 
+            meshopt_SimplifySparse | meshopt_SimplifyErrorAbsolute | meshopt_SimplifyLockBorder, 
+            &error
+        );
+        simplified_group_indices.resize(index_count);
+
+        if(s_cast<f32>(simplified_group_indices.size()) / s_cast<f32>(group_indices.size()) > SIMPLIFICATION_FAILURE_PERCENTAGE) {
+            fmt::println("new {} original {}", simplified_group_indices.size(), group_indices.size());
+            fmt::println("retry % {} error % {}", (s_cast<f32>(simplified_group_indices.size()) / s_cast<f32>(group_indices.size())), error);
+            return std::nullopt;
+        }
+
+        return std::pair{std::move(simplified_group_indices), error};
+    }
+#pragma endregion
+    
+#pragma region COMPUTE LOD GROUP DATA 
+    struct ComputeLODGroupDataInfo {
+        const std::vector<u32>& group_meshlets;
+        f32& group_error;
+        std::vector<MeshletBoundingSpheres>& bounding_spheres;
+        std::vector<MeshletSimplificationError>& simplification_errors;
+    };
+
+    static auto compute_lod_group_data(ComputeLODGroupDataInfo& info) -> BoundingSphere {
+#if 0        
+        BoundingSphere group_bounding_sphere = BoundingSphere {
+            .center = { 0.0f, 0.0f, 0.0f },
+            .radius = 0.0f
+        };
+
+        f32 weight = 0.0f;
+        for(const u32 meshlet_id : info.group_meshlets) {
+            BoundingSphere meshlet_lod_bounding_sphere = info.bounding_spheres[meshlet_id].lod_group_sphere;
+            group_bounding_sphere.center += meshlet_lod_bounding_sphere.center * meshlet_lod_bounding_sphere.radius;
+            weight += meshlet_lod_bounding_sphere.radius;
+        }
+        group_bounding_sphere.center /= weight;
+
+        
+        for(const u32 meshlet_id : info.group_meshlets) {
+            BoundingSphere meshlet_lod_bounding_sphere = info.bounding_spheres[meshlet_id].lod_group_sphere;
+            f32 d = glm::distance(meshlet_lod_bounding_sphere.center, group_bounding_sphere.center);
+            group_bounding_sphere.radius = glm::max(meshlet_lod_bounding_sphere.radius + d, group_bounding_sphere.radius);
+        }
+#else
+        std::vector<BoundingSphere> group_bounding_spheres = {};
+        group_bounding_spheres.reserve(info.group_meshlets.size());
+        for(const u32 meshlet_id : info.group_meshlets) {
+            group_bounding_spheres.push_back(info.bounding_spheres[meshlet_id].lod_group_sphere);
+        }
+
+        BoundingSphere group_bounding_sphere = y_cast<BoundingSphere>(meshopt_computeSphereBounds(
+            &group_bounding_spheres[0].center[0], 
+            group_bounding_spheres.size(), 
+            sizeof(BoundingSphere), 
+            &group_bounding_spheres[0].radius, 
+            sizeof(BoundingSphere)
+        ));
+#endif
+
+        for(const u32 meshlet_id : info.group_meshlets) {
+            info.group_error = glm::max(info.simplification_errors[meshlet_id].group_error, info.group_error);
+        }
+
+        for(const u32 meshlet_id : info.group_meshlets) {
+            info.bounding_spheres[meshlet_id].lod_parent_group_sphere = group_bounding_sphere;
+            info.simplification_errors[meshlet_id].parent_group_error = info.group_error;
+        }
+
+        return group_bounding_sphere;
+    }
+#pragma endregion
+
+#pragma region APPEND GROUP MESHLETS
+    struct AppendGroupMeshletsInfo {
+        const ProcessedMeshletsInfo& group_meshlets;
+        std::vector<u32>& meshlet_indirect_vertices;
+        std::vector<u8>& meshlet_micro_indices;
+        std::vector<AABB>& aabbs;
+        std::vector<Meshlet>& meshlets;
+    };
+
+    static void append_group_meshlets(const AppendGroupMeshletsInfo& info) {
+        u32 indirect_vertices_offset = s_cast<u32>(info.meshlet_indirect_vertices.size());
+        u32 micro_indices_offset = s_cast<u32>(info.meshlet_micro_indices.size());
+
+        info.meshlet_indirect_vertices.insert(info.meshlet_indirect_vertices.end(), info.group_meshlets.indirect_vertices.begin(), info.group_meshlets.indirect_vertices.end());
+        info.meshlet_micro_indices.insert(info.meshlet_micro_indices.end(), info.group_meshlets.micro_indices.begin(), info.group_meshlets.micro_indices.end());
+    
+        for(Meshlet meshlet : info.group_meshlets.meshlets) {
+            meshlet.indirect_vertex_offset += indirect_vertices_offset;
+            meshlet.micro_indices_offset += micro_indices_offset;
+            info.meshlets.push_back(meshlet);
+        }
+
+        info.aabbs.insert(info.aabbs.end(), info.group_meshlets.aabbs.begin(), info.group_meshlets.aabbs.end());
+    }
+#pragma endregion
+
+#pragma region GENERATE MESHLETS    
+    auto AssetConverter::generate_meshlets(const GenerateMeshletsInfo& info) -> ProcessedMeshletsInfo {
+        ProcessedMeshletsInfo ret = {};
+        
+        constexpr usize MAX_VERTICES = MAX_VERTICES_PER_MESHLET;
+        constexpr usize MAX_TRIANGLES = MAX_TRIANGLES_PER_MESHLET;
+        constexpr f32 CONE_WEIGHT = 1.0f;
+
+        usize max_meshlets = meshopt_buildMeshletsBound(info.indices.size(), MAX_VERTICES, MAX_TRIANGLES);
+        ret.meshlets.resize(max_meshlets);
+        ret.indirect_vertices.resize(max_meshlets * MAX_VERTICES);
+        ret.micro_indices.resize(max_meshlets * MAX_TRIANGLES * 3);
+
+        usize meshlet_count = meshopt_buildMeshlets(
+            r_cast<meshopt_Meshlet*>(ret.meshlets.data()),
+            ret.indirect_vertices.data(),
+            ret.micro_indices.data(),
+            info.indices.data(),
+            info.indices.size(),
+            r_cast<const f32*>(info.positions.data()),
+            info.positions.size(),
+            sizeof(f32vec3),
+            MAX_VERTICES,
+            MAX_TRIANGLES,
+            CONE_WEIGHT
+        );
+
+        const Meshlet& last = ret.meshlets[meshlet_count - 1];
+        ret.indirect_vertices.resize(last.indirect_vertex_offset + last.vertex_count);
+        ret.micro_indices.resize(last.micro_indices_offset + ((last.triangle_count * 3u + 3u) & ~3u));
+        ret.meshlets.resize(meshlet_count);
+
+        ret.bounding_spheres.resize(meshlet_count);
+        ret.aabbs.resize(meshlet_count);
+
+        using MinMax = std::pair<f32vec3, f32vec3>;
+        const MinMax empty_bounds = { glm::vec3{std::numeric_limits<f32>::max()}, glm::vec3{std::numeric_limits<f32>::lowest()} };
+
+        // meshlets dont share any output ranges so optimization and bounds can run per meshlet in parallel
+        auto [mesh_aabb_min, mesh_aabb_max] = info.thread_pool->parallel_reduce(0, meshlet_count, empty_bounds, [&](usize meshlet_index) -> MinMax {
+            const auto& meshlet = ret.meshlets[meshlet_index];
+
+            meshopt_optimizeMeshlet(
+                &ret.indirect_vertices[meshlet.indirect_vertex_offset], 
+                &ret.micro_indices[meshlet.micro_indices_offset], 
+                meshlet.triangle_count, 
+                meshlet.vertex_count
+            );
+
+            meshopt_Bounds raw_bounds = meshopt_computeMeshletBounds(
+                &ret.indirect_vertices[meshlet.indirect_vertex_offset],
+                &ret.micro_indices[meshlet.micro_indices_offset],
+                meshlet.triangle_count,
+                r_cast<const f32*>(info.positions.data()),
+                info.positions.size(),
+                sizeof(glm::vec3)
+            );
+
+            ret.bounding_spheres[meshlet_index] = BoundingSphere {
+                .center = { raw_bounds.center[0], raw_bounds.center[1], raw_bounds.center[2]},
+                .radius = raw_bounds.radius
+            };
+
+            glm::vec3 min_pos = info.positions[ret.indirect_vertices[meshlet.indirect_vertex_offset]];
+            glm::vec3 max_pos = info.positions[ret.indirect_vertices[meshlet.indirect_vertex_offset]];
+
+            for (u32 i = 0; i < meshlet.vertex_count; ++i) {
+                glm::vec3 pos = info.positions[ret.indirect_vertices[meshlet.indirect_vertex_offset + i]];
+                min_pos = glm::min(min_pos, pos);
+                max_pos = glm::max(max_pos, pos);
+            }
+
+            ret.aabbs[meshlet_index].center = (max_pos + min_pos) * 0.5f;
+            ret.aabbs[meshlet_index].extent =  (max_pos - min_pos) * 0.5f;
+
+            return { min_pos, max_pos };
+        }, [](const MinMax& a, const MinMax& b) -> MinMax {
+            return { glm::min(a.first, b.first), glm::max(a.second, b.second) };
+        }, MESHLET_GRAIN_SIZE);
+
+        ret.mesh_aabb = {
+            .center = (mesh_aabb_max + mesh_aabb_min) * 0.5f,
+            .extent =  (mesh_aabb_max - mesh_aabb_min) * 0.5f,
+        };
+
+        return ret;
+    }
+#pragma endregion
+
+#pragma region GENERATE INDEX BUFFER
+    auto AssetConverter::generate_index_buffer(const GenerateIndexBufferInfo& info) -> ProcessedIndexBufferInfo {
+        std::vector<meshopt_Stream> streams = {};
+        streams.push_back(meshopt_Stream { .data = info.unindexed_positions.data(), .size = info.unindexed_positions.size(), .stride = sizeof(f32vec3) });
+        streams.push_back(meshopt_Stream { .data = info.unindexed_normals.data(), .size = info.unindexed_normals.size(), .stride = sizeof(f32vec3) });
+        streams.push_back(meshopt_Stream { .data = info.unindexed_uvs.data(), .size = info.unindexed_uvs.size(), .stride = sizeof(f32vec2) });
+        
+        usize index_count = info.unindexed_positions.size();
+        usize unindexed_vertex_count = info.unindexed_positions.size();
+        
+        std::vector<u32> remap_table(unindexed_vertex_count);
+        usize unique_vertex_count = meshopt_generateVertexRemapMulti(remap_table.data(), nullptr, index_count, unindexed_vertex_count, streams.data(), streams.size());
+        
+        ProcessedIndexBufferInfo ret = {};
+        ret.positions.resize(unique_vertex_count);
+        ret.normals.resize(unique_vertex_count);
+        ret.uvs.resize(unique_vertex_count);
+        ret.index_buffer.resize(index_count);
+
+        meshopt_remapVertexBuffer(ret.positions.data(), info.unindexed_positions.data(), unindexed_vertex_count, sizeof(f32vec3), remap_table.data());
+        meshopt_remapVertexBuffer(ret.normals.data(), info.unindexed_normals.data(), unindexed_vertex_count, sizeof(f32vec3), remap_table.data());
+        meshopt_remapVertexBuffer(ret.uvs.data(), info.unindexed_uvs.data(), unindexed_vertex_count, sizeof(f32vec2), remap_table.data());
+        meshopt_remapIndexBuffer(ret.index_buffer.data(), nullptr, index_count, remap_table.data());
+
+        return ret;
+    }
+#pragma endregion
+
+#pragma region OPTIMIZE VERTEX CACHE
+    auto AssetConverter::optimize_vertex_cache(std::span<const u32> index_buffer, u32 vertex_count) -> std::vector<u32> {
+        std::vector<u32> optimized_index_buffer(index_buffer.size());
+        meshopt_optimizeVertexCache(optimized_index_buffer.data(), index_buffer.data(), index_buffer.size(), vertex_count);
+        return optimized_index_buffer;
+    }
+#pragma endregion
+
+#pragma region OPTIMIZE VERTEX FETCH
+    auto AssetConverter::optimize_vertex_fetch(const OptimizeVertexFetchInfo& info) -> ProcessedIndexBufferInfo {
+        std::vector<u32> remap_table(info.positions.size());
+        usize unique_vertex_count = meshopt_optimizeVertexFetchRemap(remap_table.data(), info.index_buffer.data(), info.index_buffer.size(), info.positions.size());
+        
+        ProcessedIndexBufferInfo ret = {};
+        ret.positions.resize(unique_vertex_count);
+        ret.normals.resize(unique_vertex_count);
+        ret.uvs.resize(unique_vertex_count);
+        ret.index_buffer.resize(info.index_buffer.size());
+
+        meshopt_remapVertexBuffer(ret.positions.data(), info.positions.data(), info.positions.size(), sizeof(f32vec3), remap_table.data());
+        meshopt_remapVertexBuffer(ret.normals.data(), info.normals.data(), info.normals.size(), sizeof(f32vec3), remap_table.data());
+        meshopt_remapVertexBuffer(ret.uvs.data(), info.uvs.data(), info.uvs.size(), sizeof(f32vec2), remap_table.data());
+        meshopt_remapIndexBuffer(ret.index_buffer.data(), info.index_buffer.data(), info.index_buffer.size(), remap_table.data());
+
+        return ret;
+    }
+#pragma endregion
+
+#pragma region PROCESS MESH
+    auto AssetConverter::process_mesh(const ProcessMeshInfo &info) -> ProcessedMeshInfo {
+        fastgltf::Asset& gltf_asset = *info.asset;
+        fastgltf::Mesh& gltf_mesh = info.asset->meshes[info.gltf_mesh_index];
+        fastgltf::Primitive& gltf_primitive = gltf_mesh.primitives[info.gltf_primitive_index];
+
+        std::vector<glm::vec3> vert_positions = {};
+        {
+            auto* position_attribute_iter = gltf_primitive.findAttribute("POSITION");
+            if(position_attribute_iter != gltf_primitive.attributes.end()) {
+                vert_positions = load_data<glm::vec3, false>(gltf_asset, gltf_asset.accessors[position_attribute_iter->accessorIndex], info.asset_directory);
+            }
+        }
+
+        auto fill = [](auto& vec, u32 required_size = 0) {
+            if(vec.empty()) {
+                vec.resize(required_size);
+                for(u32 i = 0; i < required_size; i++) {
+                    vec[i] = {};
+                }
+            }
+        };
+
+        u32 vertex_count = s_cast<u32>(vert_positions.size());
+
+        std::vector<glm::vec3> vert_normals = {};
+        {
+            auto* normal_attribute_iter = gltf_primitive.findAttribute("NORMAL");
+            if(normal_attribute_iter != gltf_primitive.attributes.end()) {
+                vert_normals = load_data<glm::vec3, false>(gltf_asset, gltf_asset.accessors[normal_attribute_iter->accessorIndex], info.asset_directory);
+            } else {
+                fill(vert_normals, vertex_count);
+            }
+        }
+
+        std::vector<glm::vec2> vert_uvs = {};
+        {
+            auto* uvs_attribute_iter = gltf_primitive.findAttribute("TEXCOORD_0");
+            if(uvs_attribute_iter != gltf_primitive.attributes.end()) {
+                vert_uvs = load_data<glm::vec2, false>(gltf_asset, gltf_asset.accessors[uvs_attribute_iter->accessorIndex], info.asset_directory);
+            } else {
+                fill(vert_uvs, vertex_count);
+            }
+        }
+
+        std::vector<u32> indices = {};
+        if(gltf_primitive.indicesAccessor.has_value()) {
+            indices = load_data<u32, true>(gltf_asset, gltf_asset.accessors[gltf_primitive.indicesAccessor.value()], info.asset_directory);
+        } else {
+            ProcessedIndexBufferInfo ret = generate_index_buffer(GenerateIndexBufferInfo {
+                .unindexed_positions = vert_positions,
+                .unindexed_normals = vert_normals,
+                .unindexed_uvs = vert_uvs
+            });
+
+            vert_positions = std::move(ret.positions);
+            vert_normals = std::move(ret.normals);
+            vert_uvs = std::move(ret.uvs);
+            indices = std::move(ret.index_buffer);
+        }
+        
+        {
+            ProcessedIndexBufferInfo ret = optimize_vertex_fetch(OptimizeVertexFetchInfo {
+                .positions = vert_positions,
+                .normals = vert_normals,
+                .uvs = vert_uvs,
+                .index_buffer = indices
+            });
+
+            vert_positions = std::move(ret.positions);
+            vert_normals = std::move(ret.normals);
+            vert_uvs = std::move(ret.uvs);
+            indices = std::move(ret.index_buffer);
+        }
+
+        indices = optimize_vertex_cache(indices, vertex_count);
+
+        std::vector<u32> packed_normals = {};
+        packed_normals.reserve(vert_normals.size());
+        for(const f32vec3& normal : vert_normals) {
+            packed_normals.push_back(encode_normal(normal));
+        }
+
+        std::vector<u32> packed_uvs = {};
+        packed_uvs.reserve(vert_uvs.size());
+        for(const f32vec2& uv : vert_uvs) {
+            packed_uvs.push_back(encode_uv(uv));
+        }
+
+        std::vector<Meshlet> meshlets = {};
+        std::vector<u32> meshlet_indirect_vertices = {};
+        std::vector<u8> meshlet_micro_indices = {};
+        std::vector<MeshletBoundingSpheres> bounding_spheres = {};
+        std::vector<AABB> meshlet_aabbs = {};
+        AABB mesh_aabb = {};
+
+        {
+            ProcessedMeshletsInfo ret = generate_meshlets(GenerateMeshletsInfo {
+                .indices = indices,
+                .positions = vert_positions,
+                .thread_pool = info.thread_pool,
+            });
+
+            meshlets = std::move(ret.meshlets);
+            meshlet_indirect_vertices = std::move(ret.indirect_vertices);
+            meshlet_micro_indices = std::move(ret.micro_indices);
+            
+            for(const auto& bounding_sphere : ret.bounding_spheres) {
+                bounding_spheres.push_back(MeshletBoundingSpheres {
+                    .culling_sphere = bounding_sphere,
+                    .lod_group_sphere = bounding_sphere,
+                    .lod_parent_group_sphere = {
+                        .center = glm::vec3{0.0f},
+                        .radius = 0.0f,
+                    },
+                });
+            }
+
+            meshlet_aabbs = std::move(ret.aabbs);
+            mesh_aabb = ret.mesh_aabb;
+        }
+        
+        std::vector<MeshletSimplificationError> simplification_errors = {};
+        simplification_errors.resize(meshlets.size());
+        std::fill(simplification_errors.begin(), simplification_errors.end(), MeshletSimplificationError {
+            .group_error = 0.0f,
+            .parent_group_error = std::numeric_limits<f32>::max()
+        });
+
+        std::vector<u8> vertex_locks = {};
+        vertex_locks.resize(vert_positions.size());
+        std::fill(vertex_locks.begin(), vertex_locks.end(), 0);
+
+        std::vector<u32> simplification_queue = {};
+        simplification_queue.resize(meshlets.size());
+        std::iota(simplification_queue.begin(), simplification_queue.end(), 0);
+
+        std::vector<u32> retry_queue = {};
+
+        // temporaries of a lod level are bump allocated from level_arena and dropped together once the level is merged,
+        // the pool keeps the released chunks around so later levels reuse them instead of going back to malloc
+        std::pmr::unsynchronized_pool_resource level_pool(ARENA_POOL_OPTIONS);
+        std::pmr::monotonic_buffer_resource level_arena(&level_pool);
+        std::pmr::memory_resource* const level_resource = info.use_arenas ? s_cast<std::pmr::memory_resource*>(&level_arena) : std::pmr::new_delete_resource();
+
+        while(simplification_queue.size() > 1) {
+            level_arena.release();
+
+            MeshletAdjacency adjacency = find_connected_meshlets(FindConnectedMeshletsInfo {
+                .simplification_queue = simplification_queue,
+                .meshlets = meshlets,
+                .meshlet_indirect_vertices = meshlet_indirect_vertices,
+                .meshlet_micro_indices = meshlet_micro_indices,
+                .positions = vert_positions,
+                .arena = level_resource,
+            });
+
+            std::vector<std::vector<u32>> groups = group_meshlets(GroupMeshletsInfo {
+                .adjacency = adjacency,
+                .simplification_queue = simplification_queue,
+                .arena = level_resource,
+            });
+
+            lock_group_borders(LockGroupBordersInfo {
+                .vertex_locks = vertex_locks,
+                .groups = groups,
+                .meshlets = meshlets,
+                .meshlet_indirect_vertices = meshlet_indirect_vertices,
+                .positions = vert_positions,
+                .arena = level_resource,
+            });
+
+            u32 next_lod_start = s_cast<u32>(meshlets.size());
+
+            // borders are locked, so the groups of a level simplify independently into their own slot
+            struct SimplifiedGroup {
+                bool simplified = {};
+                f32 group_error = {};
+                BoundingSphere group_bounding_sphere = {};
+                ProcessedMeshletsInfo group_meshlets = {};
+            };
+
+            std::vector<SimplifiedGroup> simplified_groups(groups.size());
+            std::atomic<u32> next_group = 0;
+            u32 const slot_count = s_cast<u32>(std::min<usize>(info.thread_pool->worker_count() + 1, groups.size()));
+
+            // arenas arent thread safe so every slot owns its own instead of a thread_local one, a thread that helps out
+            // inside generate_meshlets can end up running another slot
+            info.thread_pool->parallel_for(0, slot_count, [&](usize /*slot_index*/) {
+                std::pmr::unsynchronized_pool_resource slot_pool(ARENA_POOL_OPTIONS);
+                for(u32 group_index = next_group.fetch_add(1, std::memory_order_relaxed); group_index < groups.size(); group_index = next_group.fetch_add(1, std::memory_order_relaxed)) {
+                    const std::vector<u32>& group_meshlets = groups[group_index];
+                    if(group_meshlets.size() == 1) { continue; }
+
+                    std::pmr::monotonic_buffer_resource group_arena(&slot_pool);
+                    std::optional<std::pair<std::pmr::vector<u32>, f32>> simplification_result = simplify_meshlet_group(SimplifyMeshletGroupInfo {
+                        .group_meshlets = group_meshlets,
+                        .meshlets = meshlets,
+                        .meshlet_indirect_vertices = meshlet_indirect_vertices,
+                        .meshlet_micro_indices = meshlet_micro_indices,
+                        .positions = vert_positions,
+                        .normals = vert_normals,
+                        .vertex_locks = vertex_locks,
+                        .arena = info.use_arenas ? s_cast<std::pmr::memory_resource*>(&group_arena) : std::pmr::new_delete_resource(),
+                    });
+                    if(!simplification_result.has_value()) { continue; }
+
+                    SimplifiedGroup& simplified_group = simplified_groups[group_index];
+                    simplified_group.simplified = true;
+                    simplified_group.group_error = simplification_result->second;
+
+                    // every meshlet belongs to exactly one group, so groups only write their own bounding spheres and errors
+                    auto compute_lod_group_data_info = ComputeLODGroupDataInfo {
+                        .group_meshlets = group_meshlets,
+                        .group_error = simplified_group.group_error,
+                        .bounding_spheres = bounding_spheres,
+                        .simplification_errors = simplification_errors
+                    };
+                    simplified_group.group_bounding_sphere = compute_lod_group_data(compute_lod_group_data_info);
+
+                    simplified_group.group_meshlets = generate_meshlets(GenerateMeshletsInfo {
+                        .indices = simplification_result->first,
+                        .positions = vert_positions,
+                        .thread_pool = info.thread_pool,
+                    });
+                }
+            });
+
+            // merged in group order so the output doesnt depend on scheduling
+            for(u32 group_index = 0; group_index < groups.size(); group_index++) {
+                const std::vector<u32>& group_meshlets = groups[group_index];
+                const SimplifiedGroup& simplified_group = simplified_groups[group_index];
+
+                if(group_meshlets.size() == 1) { 
+                    retry_queue.push_back(group_meshlets[0]); 
+                    continue; 
+                }
+
+                if(!simplified_group.simplified) {
+                    retry_queue.insert(retry_queue.end(), group_meshlets.begin(), group_meshlets.end());
+                    fmt::println("retry");
+                    continue;
+                }
+
+                u32 const new_meshlets_start = s_cast<u32>(meshlets.size());
+                u32 const group_meshlet_count = s_cast<u32>(simplified_group.group_meshlets.meshlets.size());
+                append_group_meshlets(AppendGroupMeshletsInfo {
+                    .group_meshlets = simplified_group.group_meshlets,
+                    .meshlet_indirect_vertices = meshlet_indirect_vertices,
+                    .meshlet_micro_indices = meshlet_micro_indices,
+                    .aabbs = meshlet_aabbs,
+                    .meshlets = meshlets,
+                });
+
+                bounding_spheres.resize(bounding_spheres.size() + group_meshlet_count);
+                for(u32 group_meshlet_id = 0; group_meshlet_id < group_meshlet_count; group_meshlet_id++) {
+                    bounding_spheres[new_meshlets_start + group_meshlet_id] = MeshletBoundingSpheres {
+                        .culling_sphere = simplified_group.group_meshlets.bounding_spheres[group_meshlet_id],
+                        .lod_group_sphere = simplified_group.group_bounding_sphere,
+                        .lod_parent_group_sphere = {
+                            .center = glm::vec3{0.0f},
+                            .radius = 0.0f,
+                        },
+                    };
+                }
+
+                simplification_errors.resize(simplification_errors.size() + group_meshlet_count);
+                for(u32 group_meshlet_id = 0; group_meshlet_id < group_meshlet_count; group_meshlet_id++) {
+                    simplification_errors[new_meshlets_start + group_meshlet_id] = MeshletSimplificationError {
+                        .group_error = simplified_group.group_error,
+                        .parent_group_error = std::numeric_limits<f32>::max()
+                    };
+                }
+            }
+
+            simplification_queue.clear();
+            simplification_queue.resize(s_cast<u32>(meshlets.size()) - next_lod_start);
+            std::iota(simplification_queue.begin(), simplification_queue.end(), next_lod_start);
+            if(!simplification_queue.empty()) {
+                simplification_queue.insert(simplification_queue.end(), retry_queue.begin(), retry_queue.end());
+                retry_queue.clear();
+            }
+        }
+
+        return {
+            .mesh_aabb = mesh_aabb,
+            .positions = std::move(vert_positions),
+            .normals = std::move(packed_normals),
+            .uvs = std::move(packed_uvs),
+            .indices = indices,
+            .meshlets = std::move(meshlets),
+            .bounding_spheres = std::move(bounding_spheres),
+            .simplification_errors = std::move(simplification_errors),
+            .aabbs = std::move(meshlet_aabbs),
+            .micro_indices = std::move(meshlet_micro_indices),
+            .indirect_vertices = std::move(meshlet_indirect_vertices),
+            .primitive_indices = std::move(indices)
+        };
+    }
+#pragma endregion
+}
@@ -0,0 +1,139 @@
+#pragma once
+#include "pch.hpp"
+#include "common/thread_pool.hpp"
+#include <fastgltf/types.hpp>
+#include <ecs/binary_assets.hpp>
+
+namespace foundation {
+    struct ProcessedMeshInfo {
+        AABB mesh_aabb = {};
+        std::vector<f32vec3> positions = {};
+        std::vector<u32> normals = {};
+        std::vector<u32> uvs = {};
+        std::vector<u32> indices = {};
+        std::vector<Meshlet> meshlets = {};
+        std::vector<MeshletBoundingSpheres> bounding_spheres = {};
+        std::vector<MeshletSimplificationError> simplification_errors = {};
+        std::vector<AABB> aabbs = {};
+        std::vector<u8> micro_indices = {};
+        std::vector<u32> indirect_vertices = {};
+        std::vector<u32> primitive_indices = {};
+
+        static void serialize(ByteWriter& writer, const ProcessedMeshInfo& value) {
+            writer.write(value.mesh_aabb);
+            writer.write(value.positions);
+            writer.write(value.normals);
+            writer.write(value.uvs);
+            writer.write(value.indices);
+            writer.write(value.meshlets);
+            writer.write(value.bounding_spheres);
+            writer.write(value.simplification_errors);
+            writer.write(value.aabbs);
+            writer.write(value.micro_indices);
+            writer.write(value.indirect_vertices);
+            writer.write(value.primitive_indices);
+        }
+
+        static auto deserialize(ByteReader& reader) -> ProcessedMeshInfo { 
+            ProcessedMeshInfo value = {};
+            reader.read(value.mesh_aabb);
+            reader.read(value.positions);
+            reader.read(value.normals);
+            reader.read(value.uvs);
+            reader.read(value.indices);
+            reader.read(value.meshlets);
+            reader.read(value.bounding_spheres);
+            reader.read(value.simplification_errors);
+            reader.read(value.aabbs);
+            reader.read(value.micro_indices);
+            reader.read(value.indirect_vertices);
+            reader.read(value.primitive_indices);
+            return value;    
+        }
+    };
+
+    struct ProcessMeshInfo {
+        fastgltf::Asset* asset;
+        u32 gltf_mesh_index = {};
+        u32 gltf_primitive_index = {};
+        ThreadPool* thread_pool = {};
+        // external buffers that werent loaded with the asset are read from here
+        std::filesystem::path asset_directory = {};
+        // false sends the lod temporaries to new/delete instead of the per level and per group arenas, only for measuring them
+        bool use_arenas = true;
+    };
+
+    struct CookCache;
+
+    enum struct TextureEncoder : u32 {
+        // nvtt at normal quality, the slow high quality option
+        Nvtt,
+        // built in bc1/bc4/bc5 encoder, textures compressed to bc7 still go through nvtt
+        Native,
+    };
+
+    struct ConverterSettings {
+        // primitives processed at once, defaults to every compute worker plus the calling thread
+        std::optional<u32> worker_count = std::nullopt;
+        // reuse .bmesh/.btexture files of earlier cooks whose inputs didnt change
+        bool use_cook_cache = true;
+        // cooked .bmesh/.btexture files are named by their content and land here, models pointing at the same store share identical files
+        std::optional<std::filesystem::path> store_directory = std::nullopt;
+        // streaming mode, external buffers stay on disk and only the accessed ranges are read, primitives and images wait
+        // for their estimated working set to fit under this many bytes, nullopt loads every buffer up front and never waits
+        std::optional<u64> memory_budget = std::nullopt;
+        TextureEncoder texture_encoder = TextureEncoder::Nvtt;
+        // decodes the top mip of every compressed texture again and prints its psnr and throughput next to it
+        bool report_texture_quality = false;
+        // cache of the store shared by models cooking into it at the same time, the caller loads it before and saves it after
+        // all of them, nullptr loads and saves the cache of the store for this model alone
+        CookCache* cook_cache = nullptr;
+    };
+
+    // inputs are views, the caller keeps them alive for the duration of the call
+    struct GenerateMeshletsInfo {
+        std::span<const u32> indices = {};
+        std::span<const f32vec3> positions = {};
+        ThreadPool* thread_pool = {};
+    };
+
+    struct ProcessedMeshletsInfo {
+        std::vector<Meshlet> meshlets = {};
+        std::vector<u32> indirect_vertices = {};
+        std::vector<u8> micro_indices = {};
+        std::vector<BoundingSphere> bounding_spheres = {};
+        std::vector<AABB> aabbs = {};
+        AABB mesh_aabb = {};
+    };
+
+    struct GenerateIndexBufferInfo {
+        std::span<const f32vec3> unindexed_positions = {};
+        std::span<const f32vec3> unindexed_normals = {};
+        std::span<const f32vec2> unindexed_uvs = {};
+    };
+
+    struct OptimizeVertexFetchInfo {
+        std::span<const f32vec3> positions = {};
+        std::span<const f32vec3> normals = {};
+        std::span<const f32vec2> uvs = {};
+        std::span<const u32> index_buffer = {};
+    };
+
+    struct ProcessedIndexBufferInfo {
+        std::vector<f32vec3> positions = {};
+        std::vector<f32vec3> normals = {};
+        std::vector<f32vec2> uvs = {};
+        std::vector<u32> index_buffer = {};
+    };
+
+    // cpu only half of the asset pipeline, turns gltf files into .bmodel/.bmesh/.btexture without needing a gpu
+    struct AssetConverter {
+        static auto process_mesh(const ProcessMeshInfo& info) -> ProcessedMeshInfo;
+        static void convert_gltf_to_binary(const std::filesystem::path& input_path, const std::filesystem::path& output_path, ThreadPool* thread_pool, const ConverterSettings& settings = {});
+
+        static auto generate_meshlets(const GenerateMeshletsInfo& info) -> ProcessedMeshletsInfo;
+        static auto generate_index_buffer(const GenerateIndexBufferInfo& info) -> ProcessedIndexBufferInfo;
+        static auto optimize_vertex_cache(std::span<const u32> index_buffer, u32 vertex_count) -> std::vector<u32>;
+        static auto optimize_vertex_fetch(const OptimizeVertexFetchInfo& info) -> ProcessedIndexBufferInfo;
+    };
+}
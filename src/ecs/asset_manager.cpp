@@ -11,35 +11,14 @@
 namespace foundation {
     // static constexpr usize MAXIMUM_MESHLET_COUNT = ~u32(0u) >> (find_msb(MAX_TRIANGLES_PER_MESHLET));
 
-    struct LoadTextureTask : Task {
-        struct TaskInfo {
-            LoadTextureInfo load_info = {};
-            AssetProcessor * asset_processor = {};
-            u32 manifest_index = {};
-        };
-
-        TaskInfo info = {};
-        explicit LoadTextureTask(TaskInfo info) : info{std::move(info)} { chunk_count = 1; }
-
-        virtual void callback(u32 /*chunk_index*/, u32 /*thread_index*/) override {
-            info.asset_processor->load_texture(info.load_info);
-        };
-    };
-
-    struct LoadMeshTask : Task {
-        struct TaskInfo {
-            LoadMeshInfo load_info;
-            AssetProcessor * asset_processor = {};
-            u32 manifest_index = {};
-        };
-
-        TaskInfo info;
-        LoadMeshTask(TaskInfo info) : info{std::move(info)} { chunk_count = 1; }
-
-        virtual void callback(u32 /*chunk_index*/, u32 /*thread_index*/) override {
-            info.asset_processor->load_gltf_mesh(info.load_info);
-        };
-    };
+    // geometry, buffer and blas come from the loaded mesh, material and manifest slot stay the sharing meshes own
+    static auto share_mesh_geometry(const MeshGeometryData& loaded, const MeshGeometryData& own, u32 manifest_index) -> MeshGeometryData {
+        MeshGeometryData shared = loaded;
+        shared.material_type = own.material_type;
+        shared.material_index = own.material_index;
+        shared.manifest_index = manifest_index;
+        return shared;
+    }
 
     AssetManager::AssetManager(Context* _context, Scene* _scene, ThreadPool* _thread_pool, AssetProcessor* _asset_processor) : context{_context}, scene{_scene}, thread_pool{_thread_pool}, asset_processor{_asset_processor} {
         PROFILE_SCOPE;
@@ -82,6 +61,7 @@ namespace foundation {
         context->device.destroy_buffer(gpu_readback_mesh_cpu.get_state().buffers[0]);
 
         for(auto& mesh_manifest : mesh_manifest_entries) {
+            if(mesh_manifest.shared_mesh_manifest_index.has_value()) { continue; }
             if(context->device.is_buffer_id_valid(mesh_manifest.geometry_info.mesh_geometry_data.mesh_buffer)) {
                 context->device.destroy_buffer(mesh_manifest.geometry_info.mesh_geometry_data.mesh_buffer);
             }
@@ -166,6 +146,19 @@ namespace foundation {
                     });
                 }
 
+                // only files another model actually loads get shared, an unused entry was never handed to the loader
+                std::optional<u32> shared_texture_manifest_index = std::nullopt;
+                std::string const file_key = (info.path.parent_path() / texture.file_path).lexically_normal().generic_string();
+                if(!texture.file_path.empty() && !indices.empty()) {
+                    auto [file_entry, inserted] = texture_file_manifest_indices.try_emplace(file_key, texture_manifest_offset + i);
+                    if(!inserted) {
+                        TextureManifestEntry& shared_entry = texture_manifest_entries[file_entry->second];
+                        shared_entry.material_manifest_indices.insert(shared_entry.material_manifest_indices.end(), indices.begin(), indices.end());
+                        shared_texture_manifest_index = file_entry->second;
+                        indices = {};
+                    }
+                }
+
                 texture_manifest_entries.push_back(TextureManifestEntry{
                     .asset_manifest_index = asset_manifest_index,
                     .asset_local_index = i,
@@ -174,16 +167,18 @@ namespace foundation {
                     .sampler_id = {},
                     .current_resolution = {},
                     .max_resolution = texture.resolution,
+                    .shared_texture_manifest_index = shared_texture_manifest_index,
                     .name = texture.name,
                 });
             }
 
             material_manifest_entries.reserve(asset->materials.size());
             for (u32 material_index = 0; material_index < s_cast<u32>(asset->materials.size()); material_index++) {
-                auto make_texture_info = [texture_manifest_offset](const std::optional<BinaryMaterial::BinaryTextureInfo>& info) -> std::optional<MaterialManifestEntry::TextureInfo> {
+                auto make_texture_info = [this, texture_manifest_offset](const std::optional<BinaryMaterial::BinaryTextureInfo>& info) -> std::optional<MaterialManifestEntry::TextureInfo> {
                     if(!info.has_value()) { return std::nullopt; }
+                    const u32 texture_manifest_index = info->texture_index + texture_manifest_offset;
                     return std::make_optional(MaterialManifestEntry::TextureInfo {
-                        .texture_manifest_index = info->texture_index + texture_manifest_offset,
+                        .texture_manifest_index = texture_manifest_entries[texture_manifest_index].shared_texture_manifest_index.value_or(texture_manifest_index),
                         .sampler_index = 0
                     });
                 };
@@ -238,6 +233,21 @@ namespace foundation {
                         .meshlet_count = binary_mesh.meshlet_count,
                     };
 
+                    u32 const mesh_manifest_index = s_cast<u32>(mesh_manifest_entries.size());
+                    std::optional<u32> shared_mesh_manifest_index = std::nullopt;
+                    bool loading = true;
+                    std::string const file_key = (info.path.parent_path() / binary_mesh.file_path).lexically_normal().generic_string();
+                    auto [file_entry, inserted] = mesh_file_manifest_indices.try_emplace(file_key, mesh_manifest_index);
+                    if(!inserted) {
+                        MeshManifestEntry& shared_entry = mesh_manifest_entries[file_entry->second];
+                        shared_mesh_manifest_index = file_entry->second;
+                        shared_entry.sharing_mesh_manifest_indices.push_back(mesh_manifest_index);
+                        if(!shared_entry.loading) {
+                            mesh_geometry_data = share_mesh_geometry(shared_entry.geometry_info.mesh_geometry_data, mesh_geometry_data, mesh_manifest_index);
+                            loading = false;
+                        }
+                    }
+
                     update_meshes.push_back({
                         .mesh_group_index = asset_manifest->mesh_group_manifest_offset + mesh_group_index,
                         .mesh_index = mesh_index,
@@ -248,10 +258,12 @@ namespace foundation {
                         .asset_manifest_index = asset_manifest_index,
                         .asset_local_mesh_index = mesh_group_index,
                         .asset_local_primitive_index = mesh_index,
+                        .loading = loading,
                         .geometry_info = {
                             .mesh_geometry_data = mesh_geometry_data,
                             .material_manifest_index = material_index,
                         },
+                        .shared_mesh_manifest_index = shared_mesh_manifest_index,
                     });
                 }
 
@@ -307,8 +319,10 @@ namespace foundation {
                 const auto& mesh_group = asset->mesh_groups.at(mesh_group_index);
                 const auto& mesh_group_manifest = mesh_group_manifest_entries[asset_manifest->mesh_group_manifest_offset + mesh_group_index];
                 for(u32 mesh_index = 0; mesh_index < mesh_group.mesh_count; mesh_index++) {
-                    thread_pool->async_dispatch(std::make_shared<LoadMeshTask>(LoadMeshTask::TaskInfo{
-                        .load_info = {
+                    if(mesh_manifest_entries[mesh_group_manifest.mesh_manifest_indices_offset + mesh_index].shared_mesh_manifest_index.has_value()) { continue; }
+
+                    auto state = std::make_shared<MeshLoadState>(MeshLoadState {
+                        .info = {
                             .asset_path = info.path,
                             .asset = asset,
                             .mesh_group_index = mesh_group_index,
@@ -318,9 +332,14 @@ namespace foundation {
                             // .old_mesh = {},
                             .mesh_geometry_data = mesh_manifest_entries[asset_manifest->mesh_manifest_offset + mesh_group.mesh_offset + mesh_index].geometry_info.mesh_geometry_data,
                             .file_path = asset_manifest->path.parent_path() / asset->meshes[mesh_group.mesh_offset + mesh_index].file_path
-                        },
-                        .asset_processor = asset_processor,
-                    }), TaskPriority::LOW);
+                        }
+                    });
+
+                    // io/decompression/parsing/upload run as separate tasks so stages of different meshes overlap
+                    pending_mesh_uploads.push_back(thread_pool->submit_future([state]() { AssetProcessor::read_mesh_file(*state); }, TaskPriority::LOW, TaskClass::IO)
+                        .then([state]() { AssetProcessor::decompress_mesh(*state); })
+                        .then([state]() { AssetProcessor::deserialize_mesh(*state); })
+                        .then([state, processor = asset_processor]() { return processor->upload_mesh(*state); }));
                 }
             }
 
@@ -329,18 +348,14 @@ namespace foundation {
                 const auto& texture_manifest_entry = texture_manifest_entries.at(texture_manifest_index);
 
                 if (!texture_manifest_entry.material_manifest_indices.empty()) {
-                    thread_pool->async_dispatch(
-                    std::make_shared<LoadTextureTask>(LoadTextureTask::TaskInfo{
-                        .load_info = {
-                            .asset_path = asset_manifest->path,
-                            .asset = asset,
-                            .texture_index = texture_index,
-                            .texture_manifest_index = texture_manifest_index,
-                            .old_image = {},
-                            .image_path = asset_manifest->path.parent_path() / asset->textures[texture_index].file_path,
-                        },
-                        .asset_processor = asset_processor,
-                    }), TaskPriority::LOW);
+                    spawn(thread_pool, asset_processor->load_texture_async(thread_pool, LoadTextureInfo {
+                        .asset_path = asset_manifest->path,
+                        .asset = asset,
+                        .texture_index = texture_index,
+                        .texture_manifest_index = texture_manifest_index,
+                        .old_image = {},
+                        .image_path = asset_manifest->path.parent_path() / asset->textures[texture_index].file_path,
+                    }));
                 }
             }
         }
@@ -360,27 +375,34 @@ namespace foundation {
             const u32 requested_size = texture_sizes[texture_index];
             if(texture_manifest.image_id.is_empty()) { continue; }
             if(requested_size == texture_manifest.current_resolution) { continue; }
-            if(texture_manifest.loading) { continue; }
             if(requested_size < texture_manifest.current_resolution && texture_manifest.unload_delay < 254) { continue; }
+            if(texture_manifest.loading) {
+                // the in flight load got superseded, a new one is issued once the cancellation got reported back
+                texture_manifest.load_cancellation.cancel();
+                continue;
+            }
             
+            const AssetManifestEntry& asset_entry = asset_manifest_entries[texture_manifest.asset_manifest_index];
+            CancellationToken cancellation = CancellationToken::create();
+            // io queue is full, the request gets picked up again next frame
+            const bool dispatched = thread_pool->try_submit([asset_processor = asset_processor, load_info = LoadTextureInfo {
+                .asset_path = asset_entry.path,
+                .asset = asset_entry.asset.get(),
+                .texture_index = texture_manifest.asset_local_index,
+                .texture_manifest_index = texture_index,
+                .requested_resolution = requested_size,
+                .old_image = texture_manifest.image_id,
+                .image_path = asset_entry.path.parent_path() / asset_entry.asset->textures[texture_manifest.asset_local_index].file_path,
+                .cancellation = cancellation,
+            }]() {
+                asset_processor->load_texture(load_info);
+            }, TaskPriority::LOW, TaskClass::IO);
+            if(!dispatched) { continue; }
+
+            texture_manifest.load_cancellation = std::move(cancellation);
             texture_manifest.loading = true;
             texture_manifest.unload_delay = 0;
             texture_manifest.current_resolution = requested_size;
-
-            const AssetManifestEntry& asset_entry = asset_manifest_entries[texture_manifest.asset_manifest_index];
-            thread_pool->async_dispatch(
-                std::make_shared<LoadTextureTask>(LoadTextureTask::TaskInfo{
-                    .load_info = {
-                        .asset_path = asset_entry.path,
-                        .asset = asset_entry.asset.get(),
-                        .texture_index = texture_manifest.asset_local_index,
-                        .texture_manifest_index = texture_index,
-                        .requested_resolution = requested_size,
-                        .old_image = texture_manifest.image_id,
-                        .image_path = asset_entry.path.parent_path() / asset_entry.asset->textures[texture_manifest.asset_local_index].file_path,
-                    },
-                    .asset_processor = asset_processor,
-            }), TaskPriority::LOW);
         }
     }
 
@@ -409,8 +431,8 @@ namespace foundation {
         //     mesh_manifest_entry.loading = true;
         //     mesh_manifest_entry.unload_delay = 0;
 
-        //     thread_pool->async_dispatch(std::make_shared<LoadMeshTask>(LoadMeshTask::TaskInfo{
-        //         .load_info = {
+        //     auto state = std::make_shared<MeshLoadState>(MeshLoadState {
+        //         .info = {
         //             .asset_path = asset_manifest.path,
         //             .asset = asset_manifest.asset.get(),
         //             .mesh_group_index = mesh_manifest_entry.asset_local_mesh_index,
@@ -419,12 +441,27 @@ namespace foundation {
         //             .manifest_index = mesh_group_manifest_entry.mesh_manifest_indices_offset + mesh_manifest_entry.asset_local_primitive_index,
         //             .old_mesh = mesh_manifest_entry.geometry_info->mesh,
         //             .file_path = asset_manifest.path.parent_path() / asset_manifest.asset->meshes[mesh_group.mesh_offset + mesh_manifest_entry.asset_local_primitive_index].file_path
-        //         },
-        //         .asset_processor = asset_processor,
-        //     }), TaskPriority::LOW);
+        //         }
+        //     });
+
+        //     pending_mesh_uploads.push_back(thread_pool->submit_future([state]() { AssetProcessor::read_mesh_file(*state); }, TaskPriority::LOW, TaskClass::IO)
+        //         .then([state]() { AssetProcessor::decompress_mesh(*state); })
+        //         .then([state]() { AssetProcessor::deserialize_mesh(*state); })
+        //         .then([state, processor = asset_processor]() { return processor->upload_mesh(*state); }));
         // }
     }
 
+    auto AssetManager::poll_mesh_uploads() -> std::vector<MeshUploadInfo> {
+        PROFILE_SCOPE;
+        std::vector<MeshUploadInfo> finished_uploads = {};
+        std::erase_if(pending_mesh_uploads, [&](Future<MeshUploadInfo>& future) {
+            if(!future.is_ready()) { return false; }
+            if(auto upload = future.try_get()) { finished_uploads.push_back(std::move(*upload)); }
+            return true;
+        });
+        return finished_uploads;
+    }
+
     auto AssetManager::record_manifest_update(const RecordManifestUpdateInfo& info) -> RecordedManifestUpdateInfo {
         PROFILE_SCOPE;
         RecordedManifestUpdateInfo ret;
@@ -452,6 +489,25 @@ namespace foundation {
                 .mesh_index = mesh_manifest_entry.asset_local_primitive_index,
                 .mesh_geometry_data = mesh_upload_info.mesh_geometry_data
             });
+
+            for(u32 sharing_mesh_manifest_index : mesh_manifest_entry.sharing_mesh_manifest_indices) {
+                MeshManifestEntry& sharing_entry = mesh_manifest_entries[sharing_mesh_manifest_index];
+                sharing_entry.loading = false;
+                sharing_entry.geometry_info.mesh_geometry_data = share_mesh_geometry(mesh_upload_info.mesh_geometry_data, sharing_entry.geometry_info.mesh_geometry_data, sharing_mesh_manifest_index);
+
+                update_meshes.push_back({
+                    .mesh_group_index = asset_manifest_entries[sharing_entry.asset_manifest_index].mesh_group_manifest_offset + sharing_entry.asset_local_mesh_index,
+                    .mesh_index = sharing_entry.asset_local_primitive_index,
+                    .mesh_geometry_data = sharing_entry.geometry_info.mesh_geometry_data
+                });
+            }
+        }
+
+        for(const u32 texture_manifest_index : info.cancelled_textures) {
+            auto& texture_manifest = texture_manifest_entries.at(texture_manifest_index);
+            texture_manifest.current_resolution = context->device.image_info(texture_manifest.image_id).value().size.x;
+            texture_manifest.load_cancellation = {};
+            texture_manifest.loading = false;
         }
 
         for(const auto& texture_upload_info : info.uploaded_textures) {
@@ -459,6 +515,7 @@ namespace foundation {
             texture_manifest.current_resolution = context->device.image_info(texture_upload_info.dst_image).value().size.x;
             texture_manifest.image_id = texture_upload_info.dst_image;
             texture_manifest.sampler_id = texture_upload_info.sampler;
+            texture_manifest.load_cancellation = {};
             texture_manifest.loading = false;
 
             for(auto& material_using_texture_info : texture_manifest.material_manifest_indices) {
@@ -1,6 +1,7 @@
 #pragma once
 
 #include "common/thread_pool.hpp"
+#include "common/future.hpp"
 #include "pch.hpp"
 #include "graphics/context.hpp"
 #include "asset_processor.hpp"
@@ -38,6 +39,10 @@ namespace foundation {
         u8 unload_delay = {};
         bool loading = true;
         VirtualGeometryRenderInfo geometry_info = {};
+        // another mesh already loads the same file, this one takes over its buffer and blas instead of loading its own
+        std::optional<u32> shared_mesh_manifest_index = std::nullopt;
+        // entries sharing this ones file, they get its geometry whenever an upload of it lands
+        std::vector<u32> sharing_mesh_manifest_indices = {};
     };
 
     struct MeshGroupManifestEntry {
@@ -62,6 +67,10 @@ namespace foundation {
         u32 max_resolution = {};
         u8 unload_delay = {};
         bool loading = true;
+        // cancelled when a streaming request supersedes the in flight load
+        CancellationToken load_cancellation = {};
+        // another model already loads the same file, materials point at that entry and this one never gets an image
+        std::optional<u32> shared_texture_manifest_index = std::nullopt;
         std::string name = {};
     };
 
@@ -98,6 +107,7 @@ namespace foundation {
         struct RecordManifestUpdateInfo {
             std::span<const MeshUploadInfo> uploaded_meshes = {};
             std::span<const TextureUploadInfo> uploaded_textures = {};
+            std::span<const u32> cancelled_textures = {};
         };
 
         struct RecordedManifestUpdateInfo {
@@ -108,6 +118,8 @@ namespace foundation {
 
         void stream_textures();
         void stream_meshes();
+        // takes the results of every mesh load future that finished, called once per frame on the main thread
+        auto poll_mesh_uploads() -> std::vector<MeshUploadInfo>;
         auto record_manifest_update(const RecordManifestUpdateInfo& info) -> RecordedManifestUpdateInfo;
 
         Context* context;
@@ -128,6 +140,13 @@ namespace foundation {
         std::vector<u32> readback_material = {};
         std::vector<u32> texture_sizes = {};
         std::vector<u32> readback_mesh = {};
+
+        // texture file to the manifest entry loading it, cooked files are named by content so equal paths mean equal data
+        ankerl::unordered_dense::map<std::string, u32> texture_file_manifest_indices = {};
+        // same for mesh files, the converter gives identical primitives the same .bmesh
+        ankerl::unordered_dense::map<std::string, u32> mesh_file_manifest_indices = {};
+
+        std::vector<Future<MeshUploadInfo>> pending_mesh_uploads = {};
         
         daxa::TaskBuffer gpu_materials = {};
         daxa::TaskBuffer gpu_readback_material_gpu = {};
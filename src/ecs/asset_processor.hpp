@@ -2,63 +2,11 @@
 #include "pch.hpp"
 #include <mutex>
 #include "graphics/context.hpp"
-#include <fastgltf/types.hpp>
-#include <ecs/binary_assets.hpp>
+#include "common/thread_pool.hpp"
+#include "common/async_task.hpp"
+#include <ecs/asset_converter.hpp>
 
 namespace foundation {
-    struct ProcessedMeshInfo {
-        AABB mesh_aabb = {};
-        std::vector<f32vec3> positions = {};
-        std::vector<u32> normals = {};
-        std::vector<u32> uvs = {};
-        std::vector<u32> indices = {};
-        std::vector<Meshlet> meshlets = {};
-        std::vector<MeshletBoundingSpheres> bounding_spheres = {};
-        std::vector<MeshletSimplificationError> simplification_errors = {};
-        std::vector<AABB> aabbs = {};
-        std::vector<u8> micro_indices = {};
-        std::vector<u32> indirect_vertices = {};
-        std::vector<u32> primitive_indices = {};
-
-        static void serialize(ByteWriter& writer, const ProcessedMeshInfo& value) {
-            writer.write(value.mesh_aabb);
-            writer.write(value.positions);
-            writer.write(value.normals);
-            writer.write(value.uvs);
-            writer.write(value.indices);
-            writer.write(value.meshlets);
-            writer.write(value.bounding_spheres);
-            writer.write(value.simplification_errors);
-            writer.write(value.aabbs);
-            writer.write(value.micro_indices);
-            writer.write(value.indirect_vertices);
-            writer.write(value.primitive_indices);
-        }
-
-        static auto deserialize(ByteReader& reader) -> ProcessedMeshInfo { 
-            ProcessedMeshInfo value = {};
-            reader.read(value.mesh_aabb);
-            reader.read(value.positions);
-            reader.read(value.normals);
-            reader.read(value.uvs);
-            reader.read(value.indices);
-            reader.read(value.meshlets);
-            reader.read(value.bounding_spheres);
-            reader.read(value.simplification_errors);
-            reader.read(value.aabbs);
-            reader.read(value.micro_indices);
-            reader.read(value.indirect_vertices);
-            reader.read(value.primitive_indices);
-            return value;    
-        }
-    };
-
-    struct ProcessMeshInfo {
-        fastgltf::Asset* asset;
-        u32 gltf_mesh_index = {};
-        u32 gltf_primitive_index = {};
-    };
-
     struct LoadMeshInfo {
         std::filesystem::path asset_path = {};
         const BinaryAssetInfo* asset = {};
@@ -71,6 +19,14 @@ namespace foundation {
         std::filesystem::path file_path = {};
     };
 
+    // intermediate data of a mesh load, each stage consumes what the previous one produced
+    struct MeshLoadState {
+        LoadMeshInfo info = {};
+        std::vector<std::byte> compressed_data = {};
+        std::vector<std::byte> uncompressed_data = {};
+        ProcessedMeshInfo processed_info = {};
+    };
+
     struct MeshBuffers {
         daxa::BufferId staging_mesh_buffer = {};
         daxa::BufferId mesh_buffer = {};
@@ -95,6 +51,7 @@ namespace foundation {
         u32 requested_resolution = {};
         daxa::ImageId old_image = {};
         std::filesystem::path image_path = {};
+        CancellationToken cancellation = {};
     };
 
     struct TextureOffsets {
@@ -111,64 +68,57 @@ namespace foundation {
         daxa::ImageId old_image = {};
         daxa::SamplerId sampler = {};
         u32 manifest_index = {};
+        // false when the load awaits the upload and frees the staging buffer itself
+        bool destroy_staging_buffer = true;
+    };
+
+    // upload_timeline reaches upload_value once the staging buffer got copied into the image
+    struct QueuedTextureUpload {
+        daxa::BufferId staging_buffer = {};
+        u64 upload_value = {};
     };
 
     struct RecordCommands {
         daxa::ExecutableCommandList upload_commands = {};
         std::vector<MeshUploadInfo> uploaded_meshes = {};
         std::vector<TextureUploadInfo> uploaded_textures = {};
-    };
-
-    struct GenerateMeshletsInfo {
-        std::vector<u32> indices = {};
-        std::vector<f32vec3> positions = {};
-    };
-
-    struct ProcessedMeshletsInfo {
-        std::vector<Meshlet> meshlets = {};
-        std::vector<u32> indirect_vertices = {};
-        std::vector<u8> micro_indices = {};
-        std::vector<BoundingSphere> bounding_spheres = {};
-        std::vector<AABB> aabbs = {};
-        AABB mesh_aabb = {};
-    };
-
-    struct GenerateIndexBufferInfo {
-        std::vector<f32vec3> unindexed_positions = {};
-        std::vector<f32vec3> unindexed_normals = {};
-        std::vector<f32vec2> unindexed_uvs = {};
-    };
-
-    struct ProcessedIndexBufferInfo {
-        std::vector<f32vec3> positions = {};
-        std::vector<f32vec3> normals = {};
-        std::vector<f32vec2> uvs = {};
-        std::vector<u32> index_buffer = {};
+        std::vector<u32> cancelled_textures = {};
+        u64 upload_timeline_value = {};
     };
 
     struct AssetProcessor {
         AssetProcessor(Context* _context);
         ~AssetProcessor();
 
-        void load_gltf_mesh(const LoadMeshInfo& info);
+        static void read_mesh_file(MeshLoadState& state);
+        static void decompress_mesh(MeshLoadState& state);
+        static void deserialize_mesh(MeshLoadState& state);
+        auto upload_mesh(MeshLoadState& state) -> MeshUploadInfo;
         void load_texture(const LoadTextureInfo& info);
+        // same as load_texture but suspends while the file is read instead of holding a worker
+        auto load_texture_async(ThreadPool* thread_pool, LoadTextureInfo info) -> AsyncTask<>;
+        auto texture_needs_file(const LoadTextureInfo& info) -> bool;
+        auto process_texture(const LoadTextureInfo& info, std::vector<std::byte> compressed_data, bool destroy_staging_buffer = true) -> QueuedTextureUpload;
+        void cancel_texture_load(const LoadTextureInfo& info, u64 bytes_saved);
 
-        auto record_gpu_load_processing_commands() -> RecordCommands;
-
-        static auto process_mesh(const ProcessMeshInfo& info) -> ProcessedMeshInfo;
-        static void convert_gltf_to_binary(const std::filesystem::path& input_path, const std::filesystem::path& output_path);
-
-        static auto generate_meshlets(const GenerateMeshletsInfo& info) -> ProcessedMeshletsInfo;
-        static auto generate_index_buffer(const GenerateIndexBufferInfo& info) -> ProcessedIndexBufferInfo;
-        static auto optimize_vertex_cache(const std::vector<u32>& index_buffer, u32 vertex_count) -> std::vector<u32>;
-        static auto optimize_vertex_fetch(const ProcessedIndexBufferInfo& info) -> ProcessedIndexBufferInfo;
+        // finished_mesh_uploads are the results of the mesh load futures
+        auto record_gpu_load_processing_commands(std::vector<MeshUploadInfo> finished_mesh_uploads = {}) -> RecordCommands;
 
         Context* context;
 
-        std::vector<MeshUploadInfo> mesh_upload_queue = {};
         std::vector<TextureUploadInfo> texture_upload_queue = {};
 
-        std::unique_ptr<std::mutex> mesh_upload_mutex = std::make_unique<std::mutex>();
         std::unique_ptr<std::mutex> texture_upload_mutex = std::make_unique<std::mutex>();
+        // manifest indices of texture loads that got cancelled, guarded by texture_upload_mutex
+        std::vector<u32> cancelled_texture_queue = {};
+
+        std::unique_ptr<std::atomic<u64>> cancelled_load_count = std::make_unique<std::atomic<u64>>(0);
+        std::unique_ptr<std::atomic<u64>> cancelled_load_bytes = std::make_unique<std::atomic<u64>>(0);
+
+        // signaled by the submission of the upload commands, coroutines can await uploads through upload_waits
+        daxa::TimelineSemaphore upload_timeline = {};
+        // guarded by texture_upload_mutex so a queued upload knows the value of the submission that carries it
+        u64 upload_timeline_value = {};
+        std::unique_ptr<TimelineWaitList> upload_waits = std::make_unique<TimelineWaitList>();
     };
 }
\ No newline at end of file
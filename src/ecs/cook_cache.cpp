@@ -0,0 +1,80 @@
+#include "cook_cache.hpp"
+#include <utils/file_io.hpp>
+#include <utils/zstd.hpp>
+
+namespace foundation {
+    static constexpr std::string_view COOK_CACHE_FILE_NAME = "cook_cache.bin";
+
+    auto CookCache::load(const std::filesystem::path& directory) -> CookCache {
+        PROFILE_SCOPE;
+        CookCache cache = { .directory = directory };
+        std::filesystem::path const path = directory / COOK_CACHE_FILE_NAME;
+        if(!std::filesystem::exists(path)) { return cache; }
+
+        std::vector<std::byte> data = zstd_decompress(read_file_to_bytes(path));
+        ByteReader reader(data.data(), data.size());
+        if(reader.read<u32>() != VERSION) { return cache; }
+
+        std::vector<CookedMesh> cooked_meshes = {};
+        std::vector<CookedTexture> cooked_textures = {};
+        reader.read(cooked_meshes);
+        reader.read(cooked_textures);
+
+        for(CookedMesh& cooked_mesh : cooked_meshes) { cache.meshes.emplace(cooked_mesh.key, std::move(cooked_mesh)); }
+        for(CookedTexture& cooked_texture : cooked_textures) { cache.textures.emplace(cooked_texture.key, std::move(cooked_texture)); }
+        return cache;
+    }
+
+    void CookCache::save() const {
+        PROFILE_SCOPE;
+        ByteWriter writer = {};
+        writer.write(VERSION);
+
+        std::vector<CookedMesh> cooked_meshes = {};
+        std::vector<CookedTexture> cooked_textures = {};
+        {
+            std::lock_guard lock{*mutex};
+            for(const auto& [key, cooked_mesh] : meshes) { cooked_meshes.push_back(cooked_mesh); }
+            for(const auto& [key, cooked_texture] : textures) { cooked_textures.push_back(cooked_texture); }
+        }
+        writer.write(cooked_meshes);
+        writer.write(cooked_textures);
+        write_bytes_to_file(zstd_compress(writer.data, 3), directory / COOK_CACHE_FILE_NAME);
+    }
+
+    // the entry is copied out under the lock, the files are checked without holding it
+    auto CookCache::find_mesh(u64 key) const -> std::optional<CookedMesh> {
+        std::optional<CookedMesh> cooked_mesh = std::nullopt;
+        {
+            std::lock_guard lock{*mutex};
+            auto entry = meshes.find(key);
+            if(entry != meshes.end()) { cooked_mesh = entry->second; }
+        }
+        if(!cooked_mesh.has_value() || !std::filesystem::exists(directory / cooked_mesh->file_name)) { return std::nullopt; }
+        return cooked_mesh;
+    }
+
+    auto CookCache::find_texture(u64 key) const -> std::optional<CookedTexture> {
+        std::optional<CookedTexture> cooked_texture = std::nullopt;
+        {
+            std::lock_guard lock{*mutex};
+            auto entry = textures.find(key);
+            if(entry != textures.end()) { cooked_texture = entry->second; }
+        }
+        if(!cooked_texture.has_value()) { return std::nullopt; }
+        for(const std::string& file_name : cooked_texture->file_names) {
+            if(!std::filesystem::exists(directory / file_name)) { return std::nullopt; }
+        }
+        return cooked_texture;
+    }
+
+    void CookCache::insert_mesh(CookedMesh cooked_mesh) {
+        std::lock_guard lock{*mutex};
+        meshes[cooked_mesh.key] = std::move(cooked_mesh);
+    }
+
+    void CookCache::insert_texture(CookedTexture cooked_texture) {
+        std::lock_guard lock{*mutex};
+        textures[cooked_texture.key] = std::move(cooked_texture);
+    }
+}
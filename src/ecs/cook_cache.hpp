@@ -0,0 +1,78 @@
+#pragma once
+
+#include <utils/byte_utils.hpp>
+#include <mutex>
+
+namespace foundation {
+    struct CookedMesh {
+        u64 key = {};
+        std::string file_name = {};
+        u32 meshlet_count = {};
+        u32 triangle_count = {};
+        u32 vertex_count = {};
+        AABB mesh_aabb = {};
+
+        static void serialize(ByteWriter& writer, const CookedMesh& value) {
+            writer.write(value.key);
+            writer.write(value.file_name);
+            writer.write(value.meshlet_count);
+            writer.write(value.triangle_count);
+            writer.write(value.vertex_count);
+            writer.write(value.mesh_aabb);
+        }
+
+        static auto deserialize(ByteReader& reader) -> CookedMesh {
+            CookedMesh value = {};
+            reader.read(value.key);
+            reader.read(value.file_name);
+            reader.read(value.meshlet_count);
+            reader.read(value.triangle_count);
+            reader.read(value.vertex_count);
+            reader.read(value.mesh_aabb);
+            return value;
+        }
+    };
+
+    struct CookedTexture {
+        u64 key = {};
+        // the texture itself first, textures split off from it after
+        std::vector<std::string> file_names = {};
+        std::optional<u32> resolution = {};
+
+        static void serialize(ByteWriter& writer, const CookedTexture& value) {
+            writer.write(value.key);
+            writer.write(value.file_names);
+            writer.write(value.resolution);
+        }
+
+        static auto deserialize(ByteReader& reader) -> CookedTexture {
+            CookedTexture value = {};
+            reader.read(value.key);
+            reader.read(value.file_names);
+            reader.read(value.resolution);
+            return value;
+        }
+    };
+
+    // outputs of earlier cooks keyed by a hash of their inputs, lives next to the cooked files,
+    // models cooking into the same store at once share one cache so lookups and inserts go through the mutex
+    struct CookCache {
+        // bump whenever the file layout of the cache itself changes
+        static constexpr u32 VERSION = 1;
+
+        std::filesystem::path directory = {};
+        ankerl::unordered_dense::map<u64, CookedMesh> meshes = {};
+        ankerl::unordered_dense::map<u64, CookedTexture> textures = {};
+        std::unique_ptr<std::mutex> mutex = std::make_unique<std::mutex>();
+
+        // empty cache when there is none yet or it was written by another version
+        static auto load(const std::filesystem::path& directory) -> CookCache;
+        void save() const;
+
+        // entries whose files got deleted in the meantime count as misses
+        auto find_mesh(u64 key) const -> std::optional<CookedMesh>;
+        auto find_texture(u64 key) const -> std::optional<CookedTexture>;
+        void insert_mesh(CookedMesh cooked_mesh);
+        void insert_texture(CookedTexture cooked_texture);
+    };
+}
@@ -90,12 +90,16 @@ inline constexpr auto find_next_lower_po2(daxa::u32 v) -> daxa::u32 {
 #define PROFILE_SCOPE ZoneScoped
 #define PROFILE_SCOPE_NAMED(name) ZoneNamedN(name, #name, true)
 #define PROFILE_ZONE_NAMED(name) ZoneTransientN(name, #name, true)
+#define PROFILE_PLOT(name, value) TracyPlot(name, value)
+#define PROFILE_THREAD_NAME(name) tracy::SetThreadName(name)
 #else
 #define PROFILE_FRAME_START(name)
 #define PROFILE_FRAME_END(name)
 #define PROFILE_SCOPE
 #define PROFILE_SCOPE_NAMED(name)
 #define PROFILE_ZONE_NAMED(name)
+#define PROFILE_PLOT(name, value)
+#define PROFILE_THREAD_NAME(name)
 #endif
 
 #include <libassert/assert.hpp>
@@ -0,0 +1,458 @@
+#include <utils/block_compression.hpp>
+
+#include <cstring>
+
+// sse2 is part of x86-64, no dispatch needed
+#if defined(__SSE2__) || defined(_M_X64)
+#define BLOCK_COMPRESSION_SSE2 1
+#include <emmintrin.h>
+#else
+#define BLOCK_COMPRESSION_SSE2 0
+#endif
+
+namespace foundation {
+    static constexpr u32 BLOCK_DIMENSION = 4;
+    static constexpr usize BLOCK_PIXELS = 16;
+    static constexpr usize BC1_BLOCK_BYTES = 8;
+    static constexpr usize BC4_BLOCK_BYTES = 8;
+    static constexpr usize BC5_BLOCK_BYTES = 16;
+    static constexpr usize BC3_BLOCK_BYTES = 16;
+    // power iterations for the principal axis of a bc1 block, the axis converges long before the endpoints would notice
+    static constexpr u32 AXIS_ITERATIONS = 4;
+    // bc1 quantization step along the endpoint axis to palette index
+    static constexpr std::array<u32, 4> BC1_STEP_TO_INDEX = { 1, 3, 2, 0 };
+    // weight of color0 for every bc1 palette index in four color mode
+    static constexpr std::array<f32, 4> BC1_INDEX_WEIGHTS = { 1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f };
+
+    using BlockValues = std::array<f32, BLOCK_PIXELS>;
+    using BlockSteps = std::array<i32, BLOCK_PIXELS>;
+
+    // structure of arrays so four pixels fill one sse register
+    struct ColorBlock {
+        BlockValues r = {};
+        BlockValues g = {};
+        BlockValues b = {};
+    };
+
+    using Rgb8 = std::array<u8, 3>;
+
+#pragma region SIMD
+#if BLOCK_COMPRESSION_SSE2
+    static auto as_m128i(i32* pointer) -> __m128i* { return s_cast<__m128i*>(s_cast<void*>(pointer)); }
+
+    // a & mask | b & ~mask, sse2 has no blend
+    static auto select(__m128i mask, __m128i a, __m128i b) -> __m128i {
+        return _mm_or_si128(_mm_and_si128(mask, a), _mm_andnot_si128(mask, b));
+    }
+#endif
+
+    // steps[i] = clamp(round((values[i] - origin) * scale), 0, max_step)
+    static void quantize_block(const BlockValues& values, f32 origin, f32 scale, i32 max_step, BlockSteps& steps) {
+#if BLOCK_COMPRESSION_SSE2
+        __m128 const origin_v = _mm_set1_ps(origin);
+        __m128 const scale_v = _mm_set1_ps(scale);
+        __m128i const zero = _mm_setzero_si128();
+        __m128i const max_v = _mm_set1_epi32(max_step);
+        for(usize pixel = 0; pixel < BLOCK_PIXELS; pixel += 4) {
+            __m128 const value = _mm_loadu_ps(values.data() + pixel);
+            __m128i step = _mm_cvtps_epi32(_mm_mul_ps(_mm_sub_ps(value, origin_v), scale_v));
+            step = select(_mm_cmpgt_epi32(step, max_v), max_v, step);
+            step = select(_mm_cmplt_epi32(step, zero), zero, step);
+            _mm_storeu_si128(as_m128i(steps.data() + pixel), step);
+        }
+#else
+        for(usize pixel = 0; pixel < BLOCK_PIXELS; pixel++) {
+            i32 const step = s_cast<i32>(std::nearbyint((values[pixel] - origin) * scale));
+            steps[pixel] = std::clamp(step, 0, max_step);
+        }
+#endif
+    }
+
+    // dots[i] = dot(pixel_i - origin, axis)
+    static void project_block(const ColorBlock& block, glm::vec3 origin, glm::vec3 axis, BlockValues& dots) {
+#if BLOCK_COMPRESSION_SSE2
+        __m128 const origin_r = _mm_set1_ps(origin.r);
+        __m128 const origin_g = _mm_set1_ps(origin.g);
+        __m128 const origin_b = _mm_set1_ps(origin.b);
+        __m128 const axis_r = _mm_set1_ps(axis.r);
+        __m128 const axis_g = _mm_set1_ps(axis.g);
+        __m128 const axis_b = _mm_set1_ps(axis.b);
+        for(usize pixel = 0; pixel < BLOCK_PIXELS; pixel += 4) {
+            __m128 const r = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(block.r.data() + pixel), origin_r), axis_r);
+            __m128 const g = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(block.g.data() + pixel), origin_g), axis_g);
+            __m128 const b = _mm_mul_ps(_mm_sub_ps(_mm_loadu_ps(block.b.data() + pixel), origin_b), axis_b);
+            _mm_storeu_ps(dots.data() + pixel, _mm_add_ps(_mm_add_ps(r, g), b));
+        }
+#else
+        for(usize pixel = 0; pixel < BLOCK_PIXELS; pixel++) {
+            dots[pixel] = (block.r[pixel] - origin.r) * axis.r + (block.g[pixel] - origin.g) * axis.g + (block.b[pixel] - origin.b) * axis.b;
+        }
+#endif
+    }
+#pragma endregion
+
+#pragma region BLOCK IO
+    // texel of a block at (x, y) clamped to the image, edge blocks repeat the last row and column
+    static auto block_texel_index(u32 width, u32 height, u32 block_x, u32 block_y, u32 pixel) -> usize {
+        u32 const x = std::min(block_x * BLOCK_DIMENSION + pixel % BLOCK_DIMENSION, width - 1);
+        u32 const y = std::min(block_y * BLOCK_DIMENSION + pixel / BLOCK_DIMENSION, height - 1);
+        return usize{y} * width + x;
+    }
+
+    static auto load_color_block(std::span<const std::byte> rgba, u32 width, u32 height, u32 block_x, u32 block_y) -> ColorBlock {
+        ColorBlock block = {};
+        for(u32 pixel = 0; pixel < BLOCK_PIXELS; pixel++) {
+            const std::byte* texel = rgba.data() + block_texel_index(width, height, block_x, block_y, pixel) * 4;
+            block.r[pixel] = s_cast<f32>(texel[0]);
+            block.g[pixel] = s_cast<f32>(texel[1]);
+            block.b[pixel] = s_cast<f32>(texel[2]);
+        }
+        return block;
+    }
+
+    static auto load_channel_block(std::span<const std::byte> pixels, usize pixel_size, usize channel, u32 width, u32 height, u32 block_x, u32 block_y) -> BlockValues {
+        BlockValues block = {};
+        for(u32 pixel = 0; pixel < BLOCK_PIXELS; pixel++) {
+            block[pixel] = s_cast<f32>(pixels[block_texel_index(width, height, block_x, block_y, pixel) * pixel_size + channel]);
+        }
+        return block;
+    }
+
+    template <usize BLOCK_BYTES, typename EncodeFn>
+    static auto encode_blocks(u32 width, u32 height, ThreadPool* thread_pool, const EncodeFn& encode_block) -> std::vector<std::byte> {
+        u32 const blocks_x = (width + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION;
+        u32 const blocks_y = (height + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION;
+        std::vector<std::byte> blocks(usize{blocks_x} * blocks_y * BLOCK_BYTES);
+        thread_pool->parallel_for(0, blocks_y, [&](usize block_y) {
+            for(u32 block_x = 0; block_x < blocks_x; block_x++) {
+                std::array<std::byte, BLOCK_BYTES> const block = encode_block(block_x, s_cast<u32>(block_y));
+                std::memcpy(blocks.data() + (block_y * blocks_x + block_x) * BLOCK_BYTES, block.data(), BLOCK_BYTES);
+            }
+        });
+        return blocks;
+    }
+
+    template <usize BLOCK_BYTES, typename DecodeFn>
+    static void decode_blocks(std::span<const std::byte> blocks, u32 width, u32 height, const DecodeFn& decode_block) {
+        u32 const blocks_x = (width + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION;
+        u32 const blocks_y = (height + BLOCK_DIMENSION - 1) / BLOCK_DIMENSION;
+        ASSERT(blocks.size() >= usize{blocks_x} * blocks_y * BLOCK_BYTES, "not enough blocks for the image");
+        for(u32 block_y = 0; block_y < blocks_y; block_y++) {
+            for(u32 block_x = 0; block_x < blocks_x; block_x++) {
+                const std::byte* block = blocks.data() + (usize{block_y} * blocks_x + block_x) * BLOCK_BYTES;
+                for(u32 pixel = 0; pixel < BLOCK_PIXELS; pixel++) {
+                    u32 const x = block_x * BLOCK_DIMENSION + pixel % BLOCK_DIMENSION;
+                    u32 const y = block_y * BLOCK_DIMENSION + pixel / BLOCK_DIMENSION;
+                    if(x < width && y < height) { decode_block(block, pixel, usize{y} * width + x); }
+                }
+            }
+        }
+    }
+#pragma endregion
+
+#pragma region BC1
+    static auto to_565(glm::vec3 color) -> u16 {
+        glm::vec3 const clamped = glm::clamp(color, glm::vec3{0.0f}, glm::vec3{255.0f});
+        u32 const r = s_cast<u32>(std::lround(clamped.r * 31.0f / 255.0f));
+        u32 const g = s_cast<u32>(std::lround(clamped.g * 63.0f / 255.0f));
+        u32 const b = s_cast<u32>(std::lround(clamped.b * 31.0f / 255.0f));
+        return s_cast<u16>((r << 11) | (g << 5) | b);
+    }
+
+    static auto from_565(u16 color) -> Rgb8 {
+        u32 const r = (color >> 11) & 0x1f;
+        u32 const g = (color >> 5) & 0x3f;
+        u32 const b = color & 0x1f;
+        return { s_cast<u8>((r << 3) | (r >> 2)), s_cast<u8>((g << 2) | (g >> 4)), s_cast<u8>((b << 3) | (b >> 2)) };
+    }
+
+    static auto to_vec3(Rgb8 color) -> glm::vec3 {
+        return { s_cast<f32>(color[0]), s_cast<f32>(color[1]), s_cast<f32>(color[2]) };
+    }
+
+    static auto mix_rgb8(Rgb8 a, Rgb8 b, u32 weight_a, u32 weight_b) -> Rgb8 {
+        u32 const total = weight_a + weight_b;
+        Rgb8 mixed = {};
+        for(usize channel = 0; channel < 3; channel++) {
+            mixed[channel] = s_cast<u8>((a[channel] * weight_a + b[channel] * weight_b + total / 2) / total);
+        }
+        return mixed;
+    }
+
+    static auto bc1_four_color_palette(u16 color0, u16 color1) -> std::array<Rgb8, 4> {
+        Rgb8 const endpoint0 = from_565(color0);
+        Rgb8 const endpoint1 = from_565(color1);
+        return { endpoint0, endpoint1, mix_rgb8(endpoint0, endpoint1, 2, 1), mix_rgb8(endpoint0, endpoint1, 1, 2) };
+    }
+
+    // color0 > color1 picks four colors, anything else three colors and black
+    static auto bc1_palette(u16 color0, u16 color1) -> std::array<Rgb8, 4> {
+        if(color0 > color1) { return bc1_four_color_palette(color0, color1); }
+        Rgb8 const endpoint0 = from_565(color0);
+        Rgb8 const endpoint1 = from_565(color1);
+        return { endpoint0, endpoint1, mix_rgb8(endpoint0, endpoint1, 1, 1), Rgb8{} };
+    }
+
+    struct Bc1Candidate {
+        u16 color0 = {};
+        u16 color1 = {};
+        std::array<u32, BLOCK_PIXELS> indices = {};
+        f32 error = {};
+    };
+
+    // indices from projecting every pixel onto the endpoint axis, the palette is the four color one no matter how the endpoints compare
+    static auto fit_bc1_indices(const ColorBlock& block, u16 color0, u16 color1) -> Bc1Candidate {
+        Bc1Candidate candidate = { .color0 = color0, .color1 = color1 };
+        Rgb8 const endpoint0 = from_565(color0);
+        Rgb8 const endpoint1 = from_565(color1);
+        std::array<Rgb8, 4> const palette = { endpoint0, endpoint1, mix_rgb8(endpoint0, endpoint1, 2, 1), mix_rgb8(endpoint0, endpoint1, 1, 2) };
+
+        glm::vec3 const origin = to_vec3(endpoint1);
+        glm::vec3 const axis = to_vec3(endpoint0) - origin;
+        f32 const axis_length_squared = glm::dot(axis, axis);
+
+        BlockSteps steps = {};
+        if(axis_length_squared > 0.0f) {
+            BlockValues dots = {};
+            project_block(block, origin, axis, dots);
+            quantize_block(dots, 0.0f, 3.0f / axis_length_squared, 3, steps);
+        } else {
+            steps.fill(3);
+        }
+
+        for(usize pixel = 0; pixel < BLOCK_PIXELS; pixel++) {
+            u32 const index = BC1_STEP_TO_INDEX[s_cast<usize>(steps[pixel])];
+            const Rgb8& color = palette[index];
+            f32 const r = block.r[pixel] - s_cast<f32>(color[0]);
+            f32 const g = block.g[pixel] - s_cast<f32>(color[1]);
+            f32 const b = block.b[pixel] - s_cast<f32>(color[2]);
+            candidate.indices[pixel] = index;
+            candidate.error += r * r + g * g + b * b;
+        }
+        return candidate;
+    }
+
+    // least squares endpoints for the given indices, nullopt when every pixel uses the same weight
+    static auto refine_bc1_endpoints(const ColorBlock& block, const Bc1Candidate& candidate) -> std::optional<std::pair<glm::vec3, glm::vec3>> {
+        f32 aa = 0.0f;
+        f32 ab = 0.0f;
+        f32 bb = 0.0f;
+        glm::vec3 ax = {};
+        glm::vec3 bx = {};
+        for(usize pixel = 0; pixel < BLOCK_PIXELS; pixel++) {
+            f32 const a = BC1_INDEX_WEIGHTS[candidate.indices[pixel]];
+            f32 const b = 1.0f - a;
+            glm::vec3 const color = { block.r[pixel], block.g[pixel], block.b[pixel] };
+            aa += a * a;
+            ab += a * b;
+            bb += b * b;
+            ax += a * color;
+            bx += b * color;
+        }
+
+        f32 const determinant = aa * bb - ab * ab;
+        if(std::abs(determinant) < 1e-6f) { return std::nullopt; }
+        return std::pair{ (ax * bb - bx * ab) / determinant, (bx * aa - ax * ab) / determinant };
+    }
+
+    static auto encode_bc1_block(const ColorBlock& block) -> std::array<std::byte, BC1_BLOCK_BYTES> {
+        glm::vec3 mean = {};
+        glm::vec3 min_color = glm::vec3{255.0f};
+        glm::vec3 max_color = glm::vec3{0.0f};
+        for(usize pixel = 0; pixel < BLOCK_PIXELS; pixel++) {
+            glm::vec3 const color = { block.r[pixel], block.g[pixel], block.b[pixel] };
+            mean += color;
+            min_color = glm::min(min_color, color);
+            max_color = glm::max(max_color, color);
+        }
+        mean /= s_cast<f32>(BLOCK_PIXELS);
+
+        Bc1Candidate best = {};
+        if(min_color == max_color) {
+            best = fit_bc1_indices(block, to_565(mean), to_565(mean));
+        } else {
+            glm::mat3 covariance = glm::mat3{0.0f};
+            for(usize pixel = 0; pixel < BLOCK_PIXELS; pixel++) {
+                glm::vec3 const offset = glm::vec3{ block.r[pixel], block.g[pixel], block.b[pixel] } - mean;
+                covariance += glm::outerProduct(offset, offset);
+            }
+
+            // principal axis by power iteration, the bounding box diagonal is a start that is never orthogonal to it for real images
+            glm::vec3 axis = max_color - min_color;
+            for(u32 iteration = 0; iteration < AXIS_ITERATIONS; iteration++) {
+                glm::vec3 const next = covariance * axis;
+                f32 const largest = std::max({ std::abs(next.x), std::abs(next.y), std::abs(next.z) });
+                if(largest <= 0.0f) { break; }
+                axis = next / largest;
+            }
+
+            // the pixels furthest along the axis become the endpoints
+            BlockValues dots = {};
+            project_block(block, mean, axis, dots);
+            auto const [min_dot, max_dot] = std::ranges::minmax_element(dots);
+            usize const min_pixel = s_cast<usize>(std::distance(dots.begin(), min_dot));
+            usize const max_pixel = s_cast<usize>(std::distance(dots.begin(), max_dot));
+            glm::vec3 const endpoint0 = { block.r[max_pixel], block.g[max_pixel], block.b[max_pixel] };
+            glm::vec3 const endpoint1 = { block.r[min_pixel], block.g[min_pixel], block.b[min_pixel] };
+            best = fit_bc1_indices(block, to_565(endpoint0), to_565(endpoint1));
+
+            if(auto refined = refine_bc1_endpoints(block, best)) {
+                Bc1Candidate const candidate = fit_bc1_indices(block, to_565(refined->first), to_565(refined->second));
+                if(candidate.error < best.error) { best = candidate; }
+            }
+        }
+
+        // four color mode needs color0 > color1, swapping the endpoints swaps index 0 with 1 and 2 with 3
+        if(best.color0 < best.color1) {
+            std::swap(best.color0, best.color1);
+            for(u32& index : best.indices) { index ^= 1; }
+        } else if(best.color0 == best.color1) {
+            best.indices.fill(0);
+        }
+
+        u32 packed_indices = 0;
+        for(usize pixel = 0; pixel < BLOCK_PIXELS; pixel++) { packed_indices |= best.indices[pixel] << (pixel * 2); }
+
+        std::array<std::byte, BC1_BLOCK_BYTES> encoded = {};
+        std::memcpy(encoded.data() + 0, &best.color0, sizeof(u16));
+        std::memcpy(encoded.data() + 2, &best.color1, sizeof(u16));
+        std::memcpy(encoded.data() + 4, &packed_indices, sizeof(u32));
+        return encoded;
+    }
+
+    auto encode_bc1(std::span<const std::byte> rgba, u32 width, u32 height, ThreadPool* thread_pool) -> std::vector<std::byte> {
+        PROFILE_SCOPE;
+        ASSERT(rgba.size() == usize{width} * height * 4, "expected rgba8 pixels");
+        return encode_blocks<BC1_BLOCK_BYTES>(width, height, thread_pool, [&](u32 block_x, u32 block_y) {
+            return encode_bc1_block(load_color_block(rgba, width, height, block_x, block_y));
+        });
+    }
+
+    auto decode_bc1(std::span<const std::byte> blocks, u32 width, u32 height) -> std::vector<std::byte> {
+        std::vector<std::byte> rgba(usize{width} * height * 4);
+        decode_blocks<BC1_BLOCK_BYTES>(blocks, width, height, [&](const std::byte* block, u32 pixel, usize texel) {
+            u16 color0 = {};
+            u16 color1 = {};
+            u32 indices = {};
+            std::memcpy(&color0, block + 0, sizeof(u16));
+            std::memcpy(&color1, block + 2, sizeof(u16));
+            std::memcpy(&indices, block + 4, sizeof(u32));
+
+            Rgb8 const color = bc1_palette(color0, color1)[(indices >> (pixel * 2)) & 0x3];
+            bool const transparent = color0 <= color1 && ((indices >> (pixel * 2)) & 0x3) == 3;
+            rgba[texel * 4 + 0] = std::byte{color[0]};
+            rgba[texel * 4 + 1] = std::byte{color[1]};
+            rgba[texel * 4 + 2] = std::byte{color[2]};
+            rgba[texel * 4 + 3] = transparent ? std::byte{0} : std::byte{255};
+        });
+        return rgba;
+    }
+#pragma endregion
+
+#pragma region BC4
+    // index 0 and 1 are the endpoints, 2 to 7 step from red0 towards red1
+    static auto bc4_palette(u8 red0, u8 red1) -> std::array<u8, 8> {
+        std::array<u8, 8> palette = { red0, red1 };
+        if(red0 > red1) {
+            for(u32 step = 1; step < 7; step++) { palette[step + 1] = s_cast<u8>(((7 - step) * red0 + step * red1 + 3) / 7); }
+        } else {
+            for(u32 step = 1; step < 5; step++) { palette[step + 1] = s_cast<u8>(((5 - step) * red0 + step * red1 + 2) / 5); }
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+        return palette;
+    }
+
+    // eight value mode between the block minimum and maximum
+    static auto encode_bc4_block(const BlockValues& values) -> std::array<std::byte, BC4_BLOCK_BYTES> {
+        auto const [min_value, max_value] = std::ranges::minmax(values);
+        u8 const red0 = s_cast<u8>(max_value);
+        u8 const red1 = s_cast<u8>(min_value);
+
+        u64 packed_indices = 0;
+        if(red0 != red1) {
+            BlockSteps steps = {};
+            quantize_block(values, min_value, 7.0f / (max_value - min_value), 7, steps);
+            for(usize pixel = 0; pixel < BLOCK_PIXELS; pixel++) {
+                // step 7 is red0, step 0 red1 and the steps between count down from index 7
+                i32 const step = steps[pixel];
+                u64 const index = step == 7 ? 0 : step == 0 ? 1 : s_cast<u64>(8 - step);
+                packed_indices |= index << (pixel * 3);
+            }
+        }
+
+        std::array<std::byte, BC4_BLOCK_BYTES> encoded = {};
+        encoded[0] = std::byte{red0};
+        encoded[1] = std::byte{red1};
+        for(usize byte = 0; byte < 6; byte++) { encoded[2 + byte] = s_cast<std::byte>((packed_indices >> (byte * 8)) & 0xff); }
+        return encoded;
+    }
+
+    static auto decode_bc4_value(const std::byte* block, u32 pixel) -> std::byte {
+        u64 packed_indices = 0;
+        for(usize byte = 0; byte < 6; byte++) { packed_indices |= s_cast<u64>(block[2 + byte]) << (byte * 8); }
+        std::array<u8, 8> const palette = bc4_palette(s_cast<u8>(block[0]), s_cast<u8>(block[1]));
+        return std::byte{palette[(packed_indices >> (pixel * 3)) & 0x7]};
+    }
+
+    auto encode_bc4(std::span<const std::byte> red, u32 width, u32 height, ThreadPool* thread_pool) -> std::vector<std::byte> {
+        PROFILE_SCOPE;
+        ASSERT(red.size() == usize{width} * height, "expected one byte per pixel");
+        return encode_blocks<BC4_BLOCK_BYTES>(width, height, thread_pool, [&](u32 block_x, u32 block_y) {
+            return encode_bc4_block(load_channel_block(red, 1, 0, width, height, block_x, block_y));
+        });
+    }
+
+    auto encode_bc5(std::span<const std::byte> rgba, u32 width, u32 height, ThreadPool* thread_pool) -> std::vector<std::byte> {
+        PROFILE_SCOPE;
+        ASSERT(rgba.size() == usize{width} * height * 4, "expected rgba8 pixels");
+        return encode_blocks<BC5_BLOCK_BYTES>(width, height, thread_pool, [&](u32 block_x, u32 block_y) {
+            std::array<std::byte, BC4_BLOCK_BYTES> const red = encode_bc4_block(load_channel_block(rgba, 4, 0, width, height, block_x, block_y));
+            std::array<std::byte, BC4_BLOCK_BYTES> const green = encode_bc4_block(load_channel_block(rgba, 4, 1, width, height, block_x, block_y));
+            std::array<std::byte, BC5_BLOCK_BYTES> encoded = {};
+            std::ranges::copy(red, encoded.begin());
+            std::ranges::copy(green, encoded.begin() + BC4_BLOCK_BYTES);
+            return encoded;
+        });
+    }
+
+    auto decode_bc4(std::span<const std::byte> blocks, u32 width, u32 height) -> std::vector<std::byte> {
+        std::vector<std::byte> red(usize{width} * height);
+        decode_blocks<BC4_BLOCK_BYTES>(blocks, width, height, [&](const std::byte* block, u32 pixel, usize texel) {
+            red[texel] = decode_bc4_value(block, pixel);
+        });
+        return red;
+    }
+
+    auto decode_bc5(std::span<const std::byte> blocks, u32 width, u32 height) -> std::vector<std::byte> {
+        std::vector<std::byte> red_green(usize{width} * height * 2);
+        decode_blocks<BC5_BLOCK_BYTES>(blocks, width, height, [&](const std::byte* block, u32 pixel, usize texel) {
+            red_green[texel * 2 + 0] = decode_bc4_value(block, pixel);
+            red_green[texel * 2 + 1] = decode_bc4_value(block + BC4_BLOCK_BYTES, pixel);
+        });
+        return red_green;
+    }
+#pragma endregion
+
+#pragma region BC3
+    // an alpha block laid out like bc4 followed by a color block that always uses the four color palette
+    auto decode_bc3(std::span<const std::byte> blocks, u32 width, u32 height) -> std::vector<std::byte> {
+        std::vector<std::byte> rgba(usize{width} * height * 4);
+        decode_blocks<BC3_BLOCK_BYTES>(blocks, width, height, [&](const std::byte* block, u32 pixel, usize texel) {
+            u16 color0 = {};
+            u16 color1 = {};
+            u32 indices = {};
+            std::memcpy(&color0, block + BC4_BLOCK_BYTES + 0, sizeof(u16));
+            std::memcpy(&color1, block + BC4_BLOCK_BYTES + 2, sizeof(u16));
+            std::memcpy(&indices, block + BC4_BLOCK_BYTES + 4, sizeof(u32));
+
+            Rgb8 const color = bc1_four_color_palette(color0, color1)[(indices >> (pixel * 2)) & 0x3];
+            rgba[texel * 4 + 0] = std::byte{color[0]};
+            rgba[texel * 4 + 1] = std::byte{color[1]};
+            rgba[texel * 4 + 2] = std::byte{color[2]};
+            rgba[texel * 4 + 3] = decode_bc4_value(block, pixel);
+        });
+        return rgba;
+    }
+#pragma endregion
+}
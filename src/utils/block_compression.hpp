@@ -0,0 +1,20 @@
+#pragma once
+#include <common/thread_pool.hpp>
+
+namespace foundation {
+    // built in bc encoders, images are tightly packed and blocks hanging over the edge repeat the last row and column
+    // block rows are spread over the pool, blocks are laid out row by row like the gpu expects them
+
+    // rgb of rgba8 pixels, always four color blocks, alpha is ignored
+    auto encode_bc1(std::span<const std::byte> rgba, u32 width, u32 height, ThreadPool* thread_pool) -> std::vector<std::byte>;
+    // one byte per pixel
+    auto encode_bc4(std::span<const std::byte> red, u32 width, u32 height, ThreadPool* thread_pool) -> std::vector<std::byte>;
+    // red and green of rgba8 pixels as two bc4 blocks
+    auto encode_bc5(std::span<const std::byte> rgba, u32 width, u32 height, ThreadPool* thread_pool) -> std::vector<std::byte>;
+
+    // decoders measure the encoders and unpack already compressed sources, bc1 and bc3 return rgba8, bc4 one byte and bc5 red green pixels
+    auto decode_bc1(std::span<const std::byte> blocks, u32 width, u32 height) -> std::vector<std::byte>;
+    auto decode_bc3(std::span<const std::byte> blocks, u32 width, u32 height) -> std::vector<std::byte>;
+    auto decode_bc4(std::span<const std::byte> blocks, u32 width, u32 height) -> std::vector<std::byte>;
+    auto decode_bc5(std::span<const std::byte> blocks, u32 width, u32 height) -> std::vector<std::byte>;
+}
@@ -9,6 +9,24 @@ namespace foundation {
         file.close();
     }
 
+    void write_bytes_to_file_atomically(const std::vector<byte>& data, const std::filesystem::path& file_path) {
+        // the thread id keeps concurrent writers of the same file from sharing a temporary
+        std::filesystem::path temporary_path = file_path;
+        temporary_path += ".tmp" + std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+        {
+            std::ofstream file(temporary_path, std::ios_base::trunc | std::ios_base::binary);
+            file.write(r_cast<char const *>(data.data()), s_cast<std::streamsize>(data.size()));
+            file.close();
+            if(!file) {
+                std::filesystem::remove(temporary_path);
+                throw std::runtime_error("couldnt write file: " + temporary_path.string());
+            }
+        }
+
+        std::filesystem::rename(temporary_path, file_path);
+    }
+
     auto read_file_to_bytes(const std::filesystem::path& file_path) -> std::vector<std::byte> {
         if(!std::filesystem::exists(file_path)) {
             throw std::runtime_error("file hasnt been found: " + file_path.string());
@@ -23,6 +41,23 @@ namespace foundation {
         return data;
     }
 
+    auto read_file_range_to_bytes(const std::filesystem::path& file_path, u64 offset, u64 size) -> std::vector<std::byte> {
+        if(!std::filesystem::exists(file_path)) {
+            throw std::runtime_error("file hasnt been found: " + file_path.string());
+        }
+        if(offset + size > std::filesystem::file_size(file_path)) {
+            throw std::runtime_error("range is past the end of the file: " + file_path.string());
+        }
+
+        std::ifstream file(file_path, std::ios::binary);
+        file.seekg(s_cast<std::streamoff>(offset));
+        std::vector<std::byte> data = {};
+        data.resize(size);
+        file.read(r_cast<char*>(data.data()), s_cast<std::streamsize>(size));
+
+        return data;
+    }
+
     auto read_file_to_string(const std::filesystem::path& file_path) -> std::string {
         if(!std::filesystem::exists(file_path)) {
             throw std::runtime_error("file hasnt been found: " + file_path.string());
@@ -2,7 +2,11 @@
 
 namespace foundation {
     void write_bytes_to_file(const std::vector<byte>& data, const std::filesystem::path& file_path);
+    // writes to a temporary file next to file_path and renames it over, an interrupted write never leaves a partial file_path behind
+    void write_bytes_to_file_atomically(const std::vector<byte>& data, const std::filesystem::path& file_path);
 
     auto read_file_to_bytes(const std::filesystem::path& file_path) -> std::vector<std::byte>;
+    // reads size bytes starting at offset, throws when the file is shorter than that
+    auto read_file_range_to_bytes(const std::filesystem::path& file_path, u64 offset, u64 size) -> std::vector<std::byte>;
     auto read_file_to_string(const std::filesystem::path& file_path) -> std::string;
 }
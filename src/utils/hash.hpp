@@ -0,0 +1,90 @@
+#pragma once
+
+namespace foundation {
+    // order dependent 64 bit hash of everything fed into it, stable between runs so it can key files on disk
+    struct ContentHasher {
+        u64 state = 0xcbf29ce484222325ull;
+
+        void add_bytes(std::span<const std::byte> bytes) {
+            u64 const hash = ankerl::unordered_dense::hash<std::string_view>{}(std::string_view{r_cast<const char*>(bytes.data()), bytes.size()});
+            state = (std::rotl(state, 29) ^ hash) * 0x9e3779b97f4a7c15ull + bytes.size();
+        }
+
+        template<typename T>
+        requires std::is_trivially_copyable_v<T>
+        void add(const T& value) {
+            add_bytes(std::as_bytes(std::span{&value, 1}));
+        }
+
+        template<typename T>
+        requires std::is_trivially_copyable_v<T>
+        void add(const std::vector<T>& values) {
+            add_bytes(std::as_bytes(std::span{values}));
+        }
+
+        void add(std::string_view value) {
+            add_bytes(std::as_bytes(std::span{value}));
+        }
+
+        auto finish() const -> u64 { return state; }
+    };
+
+    // 128 bit murmur3 of a whole payload, wide enough to name files by their content
+    struct ContentHash {
+        u64 low = {};
+        u64 high = {};
+
+        auto operator==(const ContentHash&) const -> bool = default;
+        auto to_string() const -> std::string { return fmt::format("{:016x}{:016x}", high, low); }
+    };
+
+    inline auto hash_content(std::span<const std::byte> bytes, u64 seed = 0) -> ContentHash {
+        constexpr u64 c1 = 0x87c37b91114253d5ull;
+        constexpr u64 c2 = 0x4cf5ad432745937full;
+        auto fmix = [](u64 k) -> u64 {
+            k ^= k >> 33;
+            k *= 0xff51afd7ed558ccdull;
+            k ^= k >> 33;
+            k *= 0xc4ceb9fe1a85ec53ull;
+            k ^= k >> 33;
+            return k;
+        };
+
+        u64 h1 = seed;
+        u64 h2 = seed;
+        usize const block_count = bytes.size() / 16;
+        for(usize block = 0; block < block_count; block++) {
+            u64 k1 = {};
+            u64 k2 = {};
+            std::memcpy(&k1, bytes.data() + block * 16, sizeof(u64));
+            std::memcpy(&k2, bytes.data() + block * 16 + 8, sizeof(u64));
+
+            k1 *= c1; k1 = std::rotl(k1, 31); k1 *= c2; h1 ^= k1;
+            h1 = std::rotl(h1, 27); h1 += h2; h1 = h1 * 5 + 0x52dce729;
+            k2 *= c2; k2 = std::rotl(k2, 33); k2 *= c1; h2 ^= k2;
+            h2 = std::rotl(h2, 31); h2 += h1; h2 = h2 * 5 + 0x38495ab5;
+        }
+
+        usize const tail_size = bytes.size() & 15;
+        const std::byte* tail = bytes.data() + block_count * 16;
+        u64 k1 = {};
+        u64 k2 = {};
+        for(usize index = 0; index < tail_size; index++) {
+            u64 const value = s_cast<u64>(tail[index]);
+            if(index >= 8) { k2 ^= value << ((index - 8) * 8); }
+            else { k1 ^= value << (index * 8); }
+        }
+        if(tail_size > 8) { k2 *= c2; k2 = std::rotl(k2, 33); k2 *= c1; h2 ^= k2; }
+        if(tail_size > 0) { k1 *= c1; k1 = std::rotl(k1, 31); k1 *= c2; h1 ^= k1; }
+
+        h1 ^= bytes.size();
+        h2 ^= bytes.size();
+        h1 += h2;
+        h2 += h1;
+        h1 = fmix(h1);
+        h2 = fmix(h2);
+        h1 += h2;
+        h2 += h1;
+        return ContentHash { .low = h1, .high = h2 };
+    }
+}
@@ -0,0 +1,234 @@
+#include <utils/pixel_kernels.hpp>
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define PIXEL_KERNELS_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+// msvc emits any intrinsic without per function opt in
+#define PIXEL_KERNELS_TARGET(isa)
+#else
+#include <cpuid.h>
+#define PIXEL_KERNELS_TARGET(isa) __attribute__((target(isa)))
+#endif
+#else
+#define PIXEL_KERNELS_X86 0
+#endif
+
+namespace foundation {
+    static constexpr usize PIXEL_SIZE = 4;
+
+#pragma region SCALAR
+    static void swizzle_rgba8_scalar(const std::byte* source, std::byte* destination, usize pixel_count, std::array<u8, 4> channels) {
+        for(usize pixel = 0; pixel < pixel_count; pixel++) {
+            const std::byte* texel = source + pixel * PIXEL_SIZE;
+            std::array<std::byte, 4> const copy = { texel[0], texel[1], texel[2], texel[3] };
+            for(usize channel = 0; channel < PIXEL_SIZE; channel++) {
+                destination[pixel * PIXEL_SIZE + channel] = copy[channels[channel]];
+            }
+        }
+    }
+
+    static void extract_channel_rgba8_scalar(const std::byte* source, std::byte* destination, usize pixel_count, u32 channel) {
+        for(usize pixel = 0; pixel < pixel_count; pixel++) {
+            destination[pixel] = source[pixel * PIXEL_SIZE + channel];
+        }
+    }
+
+    static void fill_channel_rgba8_scalar(std::byte* pixels, usize pixel_count, u32 channel, std::byte value) {
+        for(usize pixel = 0; pixel < pixel_count; pixel++) {
+            pixels[pixel * PIXEL_SIZE + channel] = value;
+        }
+    }
+#pragma endregion
+
+#if PIXEL_KERNELS_X86
+    // through void so the byte to vector pointer cast doesnt trip -Wcast-align, every access is unaligned anyway
+    static auto as_m128(const std::byte* pointer) -> const __m128i* { return s_cast<const __m128i*>(s_cast<const void*>(pointer)); }
+    static auto as_m128(std::byte* pointer) -> __m128i* { return s_cast<__m128i*>(s_cast<void*>(pointer)); }
+    static auto as_m256(const std::byte* pointer) -> const __m256i* { return s_cast<const __m256i*>(s_cast<const void*>(pointer)); }
+    static auto as_m256(std::byte* pointer) -> __m256i* { return s_cast<__m256i*>(s_cast<void*>(pointer)); }
+
+    // pshufb control for four pixels, avx2 shuffles each 128 bit lane with the same control
+    static auto swizzle_shuffle(std::array<u8, 4> channels) -> __m128i {
+        alignas(16) std::array<u8, 16> shuffle = {};
+        for(usize byte = 0; byte < shuffle.size(); byte++) {
+            shuffle[byte] = s_cast<u8>((byte / PIXEL_SIZE) * PIXEL_SIZE + channels[byte % PIXEL_SIZE]);
+        }
+        return _mm_load_si128(s_cast<const __m128i*>(s_cast<const void*>(shuffle.data())));
+    }
+
+    // gathers the channel of four pixels into dword slot, every other byte is zeroed so the slots of four loads can be or-ed together
+    static auto extract_shuffle(u32 channel, usize slot) -> __m128i {
+        alignas(16) std::array<u8, 16> shuffle = {};
+        shuffle.fill(0x80);
+        for(usize pixel = 0; pixel < PIXEL_SIZE; pixel++) {
+            shuffle[slot * 4 + pixel] = s_cast<u8>(pixel * PIXEL_SIZE + channel);
+        }
+        return _mm_load_si128(s_cast<const __m128i*>(s_cast<const void*>(shuffle.data())));
+    }
+
+    static auto channel_mask(u32 channel) -> u32 {
+        return u32{0xff} << (channel * 8);
+    }
+
+#pragma region SSE4.1
+    PIXEL_KERNELS_TARGET("sse4.1")
+    static void swizzle_rgba8_sse41(const std::byte* source, std::byte* destination, usize pixel_count, std::array<u8, 4> channels) {
+        __m128i const shuffle = swizzle_shuffle(channels);
+        usize pixel = 0;
+        for(; pixel + 4 <= pixel_count; pixel += 4) {
+            __m128i const texels = _mm_loadu_si128(as_m128(source + pixel * PIXEL_SIZE));
+            _mm_storeu_si128(as_m128(destination + pixel * PIXEL_SIZE), _mm_shuffle_epi8(texels, shuffle));
+        }
+        swizzle_rgba8_scalar(source + pixel * PIXEL_SIZE, destination + pixel * PIXEL_SIZE, pixel_count - pixel, channels);
+    }
+
+    PIXEL_KERNELS_TARGET("sse4.1")
+    static void extract_channel_rgba8_sse41(const std::byte* source, std::byte* destination, usize pixel_count, u32 channel) {
+        __m128i const shuffle_a = extract_shuffle(channel, 0);
+        __m128i const shuffle_b = extract_shuffle(channel, 1);
+        __m128i const shuffle_c = extract_shuffle(channel, 2);
+        __m128i const shuffle_d = extract_shuffle(channel, 3);
+        usize pixel = 0;
+        for(; pixel + 16 <= pixel_count; pixel += 16) {
+            const std::byte* texels = source + pixel * PIXEL_SIZE;
+            __m128i const a = _mm_shuffle_epi8(_mm_loadu_si128(as_m128(texels + 0)), shuffle_a);
+            __m128i const b = _mm_shuffle_epi8(_mm_loadu_si128(as_m128(texels + 16)), shuffle_b);
+            __m128i const c = _mm_shuffle_epi8(_mm_loadu_si128(as_m128(texels + 32)), shuffle_c);
+            __m128i const d = _mm_shuffle_epi8(_mm_loadu_si128(as_m128(texels + 48)), shuffle_d);
+            _mm_storeu_si128(as_m128(destination + pixel), _mm_or_si128(_mm_or_si128(a, b), _mm_or_si128(c, d)));
+        }
+        extract_channel_rgba8_scalar(source + pixel * PIXEL_SIZE, destination + pixel, pixel_count - pixel, channel);
+    }
+
+    PIXEL_KERNELS_TARGET("sse4.1")
+    static void fill_channel_rgba8_sse41(std::byte* pixels, usize pixel_count, u32 channel, std::byte value) {
+        __m128i const mask = _mm_set1_epi32(s_cast<i32>(channel_mask(channel)));
+        __m128i const values = _mm_set1_epi8(s_cast<char>(value));
+        usize pixel = 0;
+        for(; pixel + 4 <= pixel_count; pixel += 4) {
+            __m128i const texels = _mm_loadu_si128(as_m128(pixels + pixel * PIXEL_SIZE));
+            _mm_storeu_si128(as_m128(pixels + pixel * PIXEL_SIZE), _mm_blendv_epi8(texels, values, mask));
+        }
+        fill_channel_rgba8_scalar(pixels + pixel * PIXEL_SIZE, pixel_count - pixel, channel, value);
+    }
+#pragma endregion
+
+#pragma region AVX2
+    PIXEL_KERNELS_TARGET("avx2")
+    static void swizzle_rgba8_avx2(const std::byte* source, std::byte* destination, usize pixel_count, std::array<u8, 4> channels) {
+        __m256i const shuffle = _mm256_broadcastsi128_si256(swizzle_shuffle(channels));
+        usize pixel = 0;
+        for(; pixel + 8 <= pixel_count; pixel += 8) {
+            __m256i const texels = _mm256_loadu_si256(as_m256(source + pixel * PIXEL_SIZE));
+            _mm256_storeu_si256(as_m256(destination + pixel * PIXEL_SIZE), _mm256_shuffle_epi8(texels, shuffle));
+        }
+        swizzle_rgba8_sse41(source + pixel * PIXEL_SIZE, destination + pixel * PIXEL_SIZE, pixel_count - pixel, channels);
+    }
+
+    PIXEL_KERNELS_TARGET("avx2")
+    static void extract_channel_rgba8_avx2(const std::byte* source, std::byte* destination, usize pixel_count, u32 channel) {
+        __m256i const shuffle_a = _mm256_broadcastsi128_si256(extract_shuffle(channel, 0));
+        __m256i const shuffle_b = _mm256_broadcastsi128_si256(extract_shuffle(channel, 1));
+        __m256i const shuffle_c = _mm256_broadcastsi128_si256(extract_shuffle(channel, 2));
+        __m256i const shuffle_d = _mm256_broadcastsi128_si256(extract_shuffle(channel, 3));
+        // each lane ends up with four pixels of every load, interleave the lanes back into pixel order
+        __m256i const lane_order = _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7);
+        usize pixel = 0;
+        for(; pixel + 32 <= pixel_count; pixel += 32) {
+            const std::byte* texels = source + pixel * PIXEL_SIZE;
+            __m256i const a = _mm256_shuffle_epi8(_mm256_loadu_si256(as_m256(texels + 0)), shuffle_a);
+            __m256i const b = _mm256_shuffle_epi8(_mm256_loadu_si256(as_m256(texels + 32)), shuffle_b);
+            __m256i const c = _mm256_shuffle_epi8(_mm256_loadu_si256(as_m256(texels + 64)), shuffle_c);
+            __m256i const d = _mm256_shuffle_epi8(_mm256_loadu_si256(as_m256(texels + 96)), shuffle_d);
+            __m256i const packed = _mm256_or_si256(_mm256_or_si256(a, b), _mm256_or_si256(c, d));
+            _mm256_storeu_si256(as_m256(destination + pixel), _mm256_permutevar8x32_epi32(packed, lane_order));
+        }
+        extract_channel_rgba8_sse41(source + pixel * PIXEL_SIZE, destination + pixel, pixel_count - pixel, channel);
+    }
+
+    PIXEL_KERNELS_TARGET("avx2")
+    static void fill_channel_rgba8_avx2(std::byte* pixels, usize pixel_count, u32 channel, std::byte value) {
+        __m256i const mask = _mm256_set1_epi32(s_cast<i32>(channel_mask(channel)));
+        __m256i const values = _mm256_set1_epi8(s_cast<char>(value));
+        usize pixel = 0;
+        for(; pixel + 8 <= pixel_count; pixel += 8) {
+            __m256i const texels = _mm256_loadu_si256(as_m256(pixels + pixel * PIXEL_SIZE));
+            _mm256_storeu_si256(as_m256(pixels + pixel * PIXEL_SIZE), _mm256_blendv_epi8(texels, values, mask));
+        }
+        fill_channel_rgba8_sse41(pixels + pixel * PIXEL_SIZE, pixel_count - pixel, channel, value);
+    }
+#pragma endregion
+
+    static auto cpuid(u32 leaf, u32 subleaf) -> std::array<u32, 4> {
+#if defined(_MSC_VER) && !defined(__clang__)
+        std::array<i32, 4> registers = {};
+        __cpuidex(registers.data(), s_cast<i32>(leaf), s_cast<i32>(subleaf));
+        return { s_cast<u32>(registers[0]), s_cast<u32>(registers[1]), s_cast<u32>(registers[2]), s_cast<u32>(registers[3]) };
+#else
+        std::array<u32, 4> registers = {};
+        __cpuid_count(leaf, subleaf, registers[0], registers[1], registers[2], registers[3]);
+        return registers;
+#endif
+    }
+
+    // ymm registers are only usable when the os saves them on context switches
+    static auto os_saves_avx_state() -> bool {
+#if defined(_MSC_VER) && !defined(__clang__)
+        return (_xgetbv(0) & 0x6) == 0x6;
+#else
+        u32 eax = 0;
+        u32 edx = 0;
+        __asm__("xgetbv" : "=a"(eax), "=d"(edx) : "c"(0));
+        return (eax & 0x6) == 0x6;
+#endif
+    }
+#endif
+
+    struct PixelKernelTable {
+        std::string_view instruction_set = {};
+        void (*swizzle)(const std::byte*, std::byte*, usize, std::array<u8, 4>) = {};
+        void (*extract_channel)(const std::byte*, std::byte*, usize, u32) = {};
+        void (*fill_channel)(std::byte*, usize, u32, std::byte) = {};
+    };
+
+    static auto select_pixel_kernels() -> PixelKernelTable {
+#if PIXEL_KERNELS_X86
+        u32 const max_leaf = cpuid(0, 0)[0];
+        std::array<u32, 4> const features = cpuid(1, 0);
+        bool const has_sse41 = (features[2] & (1u << 19)) != 0;
+        bool const has_avx = (features[2] & (1u << 27)) != 0 && (features[2] & (1u << 28)) != 0 && os_saves_avx_state();
+        bool const has_avx2 = has_avx && max_leaf >= 7 && (cpuid(7, 0)[1] & (1u << 5)) != 0;
+
+        if(has_avx2) { return { "avx2", swizzle_rgba8_avx2, extract_channel_rgba8_avx2, fill_channel_rgba8_avx2 }; }
+        if(has_sse41) { return { "sse4.1", swizzle_rgba8_sse41, extract_channel_rgba8_sse41, fill_channel_rgba8_sse41 }; }
+#endif
+        return { "scalar", swizzle_rgba8_scalar, extract_channel_rgba8_scalar, fill_channel_rgba8_scalar };
+    }
+
+    static auto pixel_kernels() -> const PixelKernelTable& {
+        static PixelKernelTable const table = select_pixel_kernels();
+        return table;
+    }
+
+    void swizzle_rgba8(std::span<const std::byte> source, std::span<std::byte> destination, std::array<u8, 4> channels) {
+        ASSERT(source.size() % PIXEL_SIZE == 0 && destination.size() == source.size());
+        ASSERT(std::ranges::all_of(channels, [](u8 channel) { return channel < PIXEL_SIZE; }));
+        pixel_kernels().swizzle(source.data(), destination.data(), source.size() / PIXEL_SIZE, channels);
+    }
+
+    void extract_channel_rgba8(std::span<const std::byte> source, std::span<std::byte> destination, u32 channel) {
+        ASSERT(source.size() % PIXEL_SIZE == 0 && destination.size() == source.size() / PIXEL_SIZE && channel < PIXEL_SIZE);
+        pixel_kernels().extract_channel(source.data(), destination.data(), destination.size(), channel);
+    }
+
+    void fill_channel_rgba8(std::span<std::byte> pixels, u32 channel, std::byte value) {
+        ASSERT(pixels.size() % PIXEL_SIZE == 0 && channel < PIXEL_SIZE);
+        pixel_kernels().fill_channel(pixels.data(), pixels.size() / PIXEL_SIZE, channel, value);
+    }
+
+    auto pixel_kernels_instruction_set() -> std::string_view {
+        return pixel_kernels().instruction_set;
+    }
+}
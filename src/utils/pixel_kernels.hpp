@@ -0,0 +1,15 @@
+#pragma once
+
+namespace foundation {
+    // kernels over tightly packed rgba8 pixels, the best instruction set the cpu supports is picked on first use
+
+    // channel c of every destination pixel becomes channel channels[c] of the source pixel, source and destination may be the same buffer
+    void swizzle_rgba8(std::span<const std::byte> source, std::span<std::byte> destination, std::array<u8, 4> channels);
+    // packs one channel of every source pixel into destination, one byte per pixel
+    void extract_channel_rgba8(std::span<const std::byte> source, std::span<std::byte> destination, u32 channel);
+    // sets one channel of every pixel to value
+    void fill_channel_rgba8(std::span<std::byte> pixels, u32 channel, std::byte value);
+
+    // "avx2", "sse4.1" or "scalar"
+    auto pixel_kernels_instruction_set() -> std::string_view;
+}
@@ -0,0 +1,239 @@
+#include <utils/texture_container.hpp>
+#include <utils/block_compression.hpp>
+
+#include <bit>
+#include <cstring>
+
+namespace foundation {
+    static constexpr u32 DDS_MAGIC = 0x20534444;
+    static constexpr usize DDS_HEADER_SIZE = 128;
+    static constexpr usize DDS_DX10_HEADER_SIZE = 20;
+    static constexpr u32 DDSD_MIPMAPCOUNT = 0x20000;
+    static constexpr u32 DDPF_FOURCC = 0x4;
+    static constexpr u32 DDSCAPS2_CUBEMAP = 0x200;
+    static constexpr u32 DDSCAPS2_VOLUME = 0x200000;
+    static constexpr u32 DDS_RESOURCE_MISC_TEXTURECUBE = 0x4;
+    static constexpr u32 DDS_DIMENSION_TEXTURE2D = 3;
+
+    static constexpr std::array<u8, 12> KTX2_IDENTIFIER = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32, 0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+    static constexpr usize KTX2_LEVEL_INDEX_OFFSET = 80;
+    static constexpr usize KTX2_LEVEL_SIZE = 24;
+
+    static constexpr auto four_cc(const char (&code)[5]) -> u32 {
+        return s_cast<u32>(code[0]) | (s_cast<u32>(code[1]) << 8) | (s_cast<u32>(code[2]) << 16) | (s_cast<u32>(code[3]) << 24);
+    }
+
+    template <typename T>
+    static auto read_value(std::span<const std::byte> file, usize offset) -> T {
+        T value = {};
+        std::memcpy(&value, file.data() + offset, sizeof(T));
+        return value;
+    }
+
+    static auto block_byte_size(daxa::Format format) -> usize {
+        switch(format) {
+            case daxa::Format::BC1_RGB_UNORM_BLOCK:
+            case daxa::Format::BC1_RGB_SRGB_BLOCK:
+            case daxa::Format::BC1_RGBA_UNORM_BLOCK:
+            case daxa::Format::BC1_RGBA_SRGB_BLOCK:
+            case daxa::Format::BC4_UNORM_BLOCK: return 8;
+            default: return 16;
+        }
+    }
+
+    static auto mip_byte_size(daxa::Format format, u32 width, u32 height) -> usize {
+        return usize{(width + 3) / 4} * usize{(height + 3) / 4} * block_byte_size(format);
+    }
+
+    static auto dds_fourcc_format(u32 code) -> std::optional<daxa::Format> {
+        if(code == four_cc("DXT1")) { return daxa::Format::BC1_RGBA_UNORM_BLOCK; }
+        if(code == four_cc("DXT5")) { return daxa::Format::BC3_UNORM_BLOCK; }
+        if(code == four_cc("ATI1") || code == four_cc("BC4U")) { return daxa::Format::BC4_UNORM_BLOCK; }
+        if(code == four_cc("ATI2") || code == four_cc("BC5U")) { return daxa::Format::BC5_UNORM_BLOCK; }
+        return std::nullopt;
+    }
+
+    // typeless formats are read as unorm
+    static auto dxgi_format(u32 format) -> std::optional<daxa::Format> {
+        switch(format) {
+            case 70: case 71: return daxa::Format::BC1_RGBA_UNORM_BLOCK;
+            case 72: return daxa::Format::BC1_RGBA_SRGB_BLOCK;
+            case 76: case 77: return daxa::Format::BC3_UNORM_BLOCK;
+            case 78: return daxa::Format::BC3_SRGB_BLOCK;
+            case 79: case 80: return daxa::Format::BC4_UNORM_BLOCK;
+            case 82: case 83: return daxa::Format::BC5_UNORM_BLOCK;
+            case 97: case 98: return daxa::Format::BC7_UNORM_BLOCK;
+            case 99: return daxa::Format::BC7_SRGB_BLOCK;
+            default: return std::nullopt;
+        }
+    }
+
+    static auto vk_format(u32 format) -> std::optional<daxa::Format> {
+        switch(format) {
+            case 131: return daxa::Format::BC1_RGB_UNORM_BLOCK;
+            case 132: return daxa::Format::BC1_RGB_SRGB_BLOCK;
+            case 133: return daxa::Format::BC1_RGBA_UNORM_BLOCK;
+            case 134: return daxa::Format::BC1_RGBA_SRGB_BLOCK;
+            case 137: return daxa::Format::BC3_UNORM_BLOCK;
+            case 138: return daxa::Format::BC3_SRGB_BLOCK;
+            case 139: return daxa::Format::BC4_UNORM_BLOCK;
+            case 141: return daxa::Format::BC5_UNORM_BLOCK;
+            case 145: return daxa::Format::BC7_UNORM_BLOCK;
+            case 146: return daxa::Format::BC7_SRGB_BLOCK;
+            default: return std::nullopt;
+        }
+    }
+
+    // a chain longer than the image allows is as broken as a truncated one
+    static auto valid_mip_count(u32 width, u32 height, u32 mip_count) -> bool {
+        return mip_count >= 1 && mip_count <= s_cast<u32>(std::bit_width(std::max(width, height)));
+    }
+
+    static auto parse_dds(std::span<const std::byte> file) -> std::optional<CompressedImage> {
+        if(file.size() < DDS_HEADER_SIZE) { return std::nullopt; }
+
+        u32 const flags = read_value<u32>(file, 8);
+        u32 const height = read_value<u32>(file, 12);
+        u32 const width = read_value<u32>(file, 16);
+        u32 const pixel_format_flags = read_value<u32>(file, 80);
+        u32 const pixel_format_code = read_value<u32>(file, 84);
+        u32 const caps2 = read_value<u32>(file, 112);
+        if((caps2 & (DDSCAPS2_CUBEMAP | DDSCAPS2_VOLUME)) != 0 || (pixel_format_flags & DDPF_FOURCC) == 0) { return std::nullopt; }
+
+        std::optional<daxa::Format> format = std::nullopt;
+        usize data_offset = DDS_HEADER_SIZE;
+        if(pixel_format_code == four_cc("DX10")) {
+            if(file.size() < DDS_HEADER_SIZE + DDS_DX10_HEADER_SIZE) { return std::nullopt; }
+
+            u32 const resource_dimension = read_value<u32>(file, DDS_HEADER_SIZE + 4);
+            u32 const misc_flags = read_value<u32>(file, DDS_HEADER_SIZE + 8);
+            u32 const array_size = read_value<u32>(file, DDS_HEADER_SIZE + 12);
+            if(resource_dimension != DDS_DIMENSION_TEXTURE2D || (misc_flags & DDS_RESOURCE_MISC_TEXTURECUBE) != 0 || array_size > 1) { return std::nullopt; }
+
+            format = dxgi_format(read_value<u32>(file, DDS_HEADER_SIZE));
+            data_offset += DDS_DX10_HEADER_SIZE;
+        } else {
+            format = dds_fourcc_format(pixel_format_code);
+        }
+
+        u32 const mip_count = (flags & DDSD_MIPMAPCOUNT) != 0 ? std::max(read_value<u32>(file, 28), 1u) : 1u;
+        if(!format.has_value() || width == 0 || height == 0 || !valid_mip_count(width, height, mip_count)) { return std::nullopt; }
+
+        CompressedImage image = {
+            .width = width,
+            .height = height,
+            .format = format.value(),
+            .mipmaps = {},
+        };
+
+        // mips follow each other without padding
+        usize offset = data_offset;
+        for(u32 mip = 0; mip < mip_count; mip++) {
+            usize const size = mip_byte_size(image.format, std::max(width >> mip, 1u), std::max(height >> mip, 1u));
+            if(offset + size > file.size()) { return std::nullopt; }
+
+            image.mipmaps.push_back(file.subspan(offset, size));
+            offset += size;
+        }
+        return image;
+    }
+
+    static auto parse_ktx2(std::span<const std::byte> file) -> std::optional<CompressedImage> {
+        if(file.size() < KTX2_LEVEL_INDEX_OFFSET) { return std::nullopt; }
+
+        u32 const format_code = read_value<u32>(file, 12);
+        u32 const width = read_value<u32>(file, 20);
+        u32 const height = read_value<u32>(file, 24);
+        u32 const depth = read_value<u32>(file, 28);
+        u32 const layer_count = read_value<u32>(file, 32);
+        u32 const face_count = read_value<u32>(file, 36);
+        // zero asks the loader to build the chain, the file only has the top mip then
+        u32 const mip_count = std::max(read_value<u32>(file, 40), 1u);
+        u32 const supercompression_scheme = read_value<u32>(file, 44);
+
+        // basis universal and zstd payloads would need their own transcoders
+        std::optional<daxa::Format> const format = vk_format(format_code);
+        if(!format.has_value() || supercompression_scheme != 0 || depth > 1 || layer_count > 1 || face_count != 1) { return std::nullopt; }
+        if(width == 0 || height == 0 || !valid_mip_count(width, height, mip_count)) { return std::nullopt; }
+        if(file.size() < KTX2_LEVEL_INDEX_OFFSET + usize{mip_count} * KTX2_LEVEL_SIZE) { return std::nullopt; }
+
+        CompressedImage image = {
+            .width = width,
+            .height = height,
+            .format = format.value(),
+            .mipmaps = {},
+        };
+
+        // the level index starts at the top mip even though the data is stored smallest first
+        for(u32 mip = 0; mip < mip_count; mip++) {
+            usize const level_offset = KTX2_LEVEL_INDEX_OFFSET + usize{mip} * KTX2_LEVEL_SIZE;
+            u64 const offset = read_value<u64>(file, level_offset);
+            u64 const size = read_value<u64>(file, level_offset + 8);
+            if(size != mip_byte_size(image.format, std::max(width >> mip, 1u), std::max(height >> mip, 1u)) || offset > file.size() || size > file.size() - offset) { return std::nullopt; }
+
+            image.mipmaps.push_back(file.subspan(s_cast<usize>(offset), s_cast<usize>(size)));
+        }
+        return image;
+    }
+
+    auto is_compressed_image_container(std::span<const std::byte> file) -> bool {
+        bool const dds = file.size() >= sizeof(u32) && read_value<u32>(file, 0) == DDS_MAGIC;
+        bool const ktx2 = file.size() >= KTX2_IDENTIFIER.size() && std::memcmp(file.data(), KTX2_IDENTIFIER.data(), KTX2_IDENTIFIER.size()) == 0;
+        return dds || ktx2;
+    }
+
+    auto parse_compressed_image(std::span<const std::byte> file) -> std::optional<CompressedImage> {
+        if(file.size() >= sizeof(u32) && read_value<u32>(file, 0) == DDS_MAGIC) { return parse_dds(file); }
+        if(is_compressed_image_container(file)) { return parse_ktx2(file); }
+        return std::nullopt;
+    }
+
+    auto can_decode_compressed_image(const CompressedImage& image) -> bool {
+        return image.format != daxa::Format::BC7_UNORM_BLOCK && image.format != daxa::Format::BC7_SRGB_BLOCK;
+    }
+
+    auto decode_compressed_image(const CompressedImage& image) -> std::vector<std::byte> {
+        ASSERT(can_decode_compressed_image(image), "bc7 cant be decoded");
+        std::span<const std::byte> const blocks = image.mipmaps[0];
+        usize const pixel_count = usize{image.width} * image.height;
+        switch(image.format) {
+            case daxa::Format::BC1_RGB_UNORM_BLOCK:
+            case daxa::Format::BC1_RGB_SRGB_BLOCK: {
+                // without alpha the three color mode decodes its fourth index to opaque black
+                std::vector<std::byte> rgba = decode_bc1(blocks, image.width, image.height);
+                for(usize pixel = 0; pixel < pixel_count; pixel++) { rgba[pixel * 4 + 3] = std::byte{255}; }
+                return rgba;
+            }
+            case daxa::Format::BC1_RGBA_UNORM_BLOCK:
+            case daxa::Format::BC1_RGBA_SRGB_BLOCK: { return decode_bc1(blocks, image.width, image.height); }
+            case daxa::Format::BC3_UNORM_BLOCK:
+            case daxa::Format::BC3_SRGB_BLOCK: { return decode_bc3(blocks, image.width, image.height); }
+            case daxa::Format::BC4_UNORM_BLOCK: {
+                std::vector<std::byte> const red = decode_bc4(blocks, image.width, image.height);
+                std::vector<std::byte> rgba(pixel_count * 4);
+                for(usize pixel = 0; pixel < pixel_count; pixel++) {
+                    rgba[pixel * 4 + 0] = red[pixel];
+                    rgba[pixel * 4 + 1] = red[pixel];
+                    rgba[pixel * 4 + 2] = red[pixel];
+                    rgba[pixel * 4 + 3] = std::byte{255};
+                }
+                return rgba;
+            }
+            case daxa::Format::BC5_UNORM_BLOCK: {
+                std::vector<std::byte> const red_green = decode_bc5(blocks, image.width, image.height);
+                std::vector<std::byte> rgba(pixel_count * 4);
+                for(usize pixel = 0; pixel < pixel_count; pixel++) {
+                    f32 const x = s_cast<f32>(red_green[pixel * 2 + 0]) / 127.5f - 1.0f;
+                    f32 const y = s_cast<f32>(red_green[pixel * 2 + 1]) / 127.5f - 1.0f;
+                    f32 const z = std::sqrt(std::max(1.0f - x * x - y * y, 0.0f));
+                    rgba[pixel * 4 + 0] = red_green[pixel * 2 + 0];
+                    rgba[pixel * 4 + 1] = red_green[pixel * 2 + 1];
+                    rgba[pixel * 4 + 2] = s_cast<std::byte>(std::lround((z + 1.0f) * 127.5f));
+                    rgba[pixel * 4 + 3] = std::byte{255};
+                }
+                return rgba;
+            }
+            default: return {};
+        }
+    }
+}
@@ -0,0 +1,20 @@
+#pragma once
+
+namespace foundation {
+    // block compressed 2d image read out of a dds or ktx2 file, mipmaps view the file and go from largest to smallest
+    struct CompressedImage {
+        u32 width = {};
+        u32 height = {};
+        daxa::Format format = {};
+        std::vector<std::span<const std::byte>> mipmaps = {};
+    };
+
+    // true for anything starting like a dds or ktx2 file, whether or not parse_compressed_image can read it
+    auto is_compressed_image_container(std::span<const std::byte> file) -> bool;
+    // nullopt unless the file is a single 2d image with a bc1/bc3/bc4/bc5/bc7 payload, supercompressed ktx2 (basis, zstd) included
+    auto parse_compressed_image(std::span<const std::byte> file) -> std::optional<CompressedImage>;
+    // everything but bc7
+    auto can_decode_compressed_image(const CompressedImage& image) -> bool;
+    // top mip as rgba8, bc4 is replicated to rgb, bc5 is treated as a normal map and gets blue rebuilt
+    auto decode_compressed_image(const CompressedImage& image) -> std::vector<std::byte>;
+}